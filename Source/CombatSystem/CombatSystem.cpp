@@ -2,5 +2,22 @@
 
 #include "CombatSystem.h"
 #include "Modules/ModuleManager.h"
+#include "Engine/World.h"
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, CombatSystem, "CombatSystem" );
+
+static int32 DisableCosmetics = 0;
+FAutoConsoleVariableRef CVARDisableCosmetics(
+	TEXT("CS.DisableCosmetics"),
+	DisableCosmetics,
+	TEXT("Skip every combat cosmetic as a dedicated server does, to measure the gameplay cost alone"),
+	ECVF_Cheat);
+
+bool CSAreCosmeticsEnabled(const UWorld* World)
+{
+#if CS_WITH_COSMETICS
+	return DisableCosmetics <= 0 && World && World->GetNetMode() != NM_DedicatedServer;
+#else
+	return false;
+#endif
+}
@@ -3,8 +3,21 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
 
 #define SURFACE_FLESH			SurfaceType1
 #define SURFACE_FLESH_CRITICAL	SurfaceType2
 
-#define COLLISION_WEAPON		ECC_GameTraceChannel1
\ No newline at end of file
+#define COLLISION_WEAPON		ECC_GameTraceChannel1
+
+DECLARE_STATS_GROUP(TEXT("CombatSystem"), STATGROUP_CombatSystem, STATCAT_Advanced);
+
+//Effects, sounds, camera shakes, force feedback and purely visual components, compiled out of dedicated server builds
+#ifndef CS_WITH_COSMETICS
+#define CS_WITH_COSMETICS (!UE_SERVER)
+#endif
+
+class UWorld;
+
+//False on dedicated servers and while CS.DisableCosmetics is set, cosmetic paths early out on it
+COMBATSYSTEM_API bool CSAreCosmeticsEnabled(const UWorld* World);
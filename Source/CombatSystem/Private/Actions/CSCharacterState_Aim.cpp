@@ -31,13 +31,17 @@ void UCSCharacterState_Aim::EnterState(uint8 NewSubstate)
 
 	if (!Character->IsTargetLocked())
 	{
-		Character->SetCrosshairActive(true);
+		Character->SetUICrosshairActive(true);
 	}
 
 	Character->ChangeCombatType(CSCombatType::RANGED);
 	
-	Character->GetCameraManager()->SetLookUpSpeed(Character->GetCameraManager()->AimLookUpSpeed);
-	Character->GetCameraManager()->SetTurnSpeed(Character->GetCameraManager()->AimTurnSpeed);
+	UCSCameraManagerComponent* CameraManager = Character->GetCameraManager();
+	if (CameraManager)
+	{
+		CameraManager->SetLookUpSpeed(CameraManager->AimLookUpSpeed);
+		CameraManager->SetTurnSpeed(CameraManager->AimTurnSpeed);
+	}
 }
 
 
@@ -54,7 +58,7 @@ void UCSCharacterState_Aim::UpdateState(float DeltaTime)
 
 void UCSCharacterState_Aim::ExitState()
 {
-	Character->SetCrosshairActive(false);
+	Character->SetUICrosshairActive(false);
 
 	Character->ChangeCombatType(CSCombatType::MELEE);
 
@@ -64,8 +68,12 @@ void UCSCharacterState_Aim::ExitState()
 		Character->GetCharacterMovement()->bOrientRotationToMovement = true;
 	}
 
-	Character->GetCameraManager()->SetLookUpSpeed(Character->GetCameraManager()->GetDefaultLookUpSpeed());
-	Character->GetCameraManager()->SetTurnSpeed(Character->GetCameraManager()->GetDefaultLookUpSpeed());
+	UCSCameraManagerComponent* CameraManager = Character->GetCameraManager();
+	if (CameraManager)
+	{
+		CameraManager->SetLookUpSpeed(CameraManager->GetDefaultLookUpSpeed());
+		CameraManager->SetTurnSpeed(CameraManager->GetDefaultLookUpSpeed());
+	}
 	
 	if (CurrentSubstate == (uint8)CharacterSubstateType_Aim::RECOIL_AIM)
 	{
@@ -132,7 +140,7 @@ void UCSCharacterState_Aim::StartRecoiling()
 	if (RangedWeapon)
 	{
 		RangedWeapon->StartRecoiling();
-		Character->GetCameraManager()->PlayCameraShake(RecoiledAimShake, 1.0f);
+		Character->PlayCameraShake(RecoiledAimShake, 1.0f);
 		
 		if (Character->IsPlayerControlled())
 		{
@@ -159,8 +167,8 @@ void UCSCharacterState_Aim::Shoot()
 	if (RangedWeapon)
 	{
 		RangedWeapon->Shoot();
-		Character->GetCameraManager()->StopCameraShake(RecoiledAimShake);
-		Character->GetCameraManager()->PlayCameraShake(ShootShake, 0.5);
+		Character->StopCameraShake(RecoiledAimShake);
+		Character->PlayCameraShake(ShootShake, 0.5);
 		
 		if (ShootForceFeedback && Character->IsPlayerControlled())
 		{
@@ -9,7 +9,7 @@
 #include "CSCharacter.h"
 #include "Components/CSStaminaComponent.h"
 #include "Components/CSCameraManagerComponent.h"
-#include "Equipment/CSMeleeWeapon.h"
+#include "Components/CSMeleeWeaponComponent.h"
 
 UCSCharacterState_Attack::UCSCharacterState_Attack() : UCSCharacterState()
 {
@@ -65,17 +65,17 @@ void UCSCharacterState_Attack::EnterState(uint8 NewSubstate)
 	{
 	case (uint8)CharacterSubstateType_Attack::DEFAULT_ATTACK:
 		if (CurrentConsecutiveAttacks < DefaultAttackAnimMontages.Num()) { Character->PlayAnimMontage(DefaultAttackAnimMontages[CurrentConsecutiveAttacks]); }
-		if (CurrentConsecutiveAttacks < DefaultAttackShakes.Num()) { Character->GetCameraManager()->PlayCameraShake(DefaultAttackShakes[CurrentConsecutiveAttacks], 1.0f); }
+		if (CurrentConsecutiveAttacks < DefaultAttackShakes.Num()) { Character->PlayCameraShake(DefaultAttackShakes[CurrentConsecutiveAttacks], 1.0f); }
 		break;
 
 	case (uint8)CharacterSubstateType_Attack::SPIRAL_ATTACK:
 		Character->PlayAnimMontage(SpiralAttackAnimMontage);
-		if (RollingAttackShake) { Character->GetCameraManager()->PlayCameraShake(RollingAttackShake, 1.0f); }
+		if (RollingAttackShake) { Character->PlayCameraShake(RollingAttackShake, 1.0f); }
 		break;
 
 	case (uint8)CharacterSubstateType_Attack::ROLL_ATTACK:
 		Character->PlayAnimMontage(RollAttackAnimMontage);
-		if (RollingAttackShake) { Character->GetCameraManager()->PlayCameraShake(RollingAttackShake, 1.0f); }
+		if (RollingAttackShake) { Character->PlayCameraShake(RollingAttackShake, 1.0f); }
 		break;
 
 	case (uint8)CharacterSubstateType_Attack::STRONG_ATTACK:
@@ -88,12 +88,6 @@ void UCSCharacterState_Attack::EnterState(uint8 NewSubstate)
 	}
 
 	//UE_LOG(LogTemp, Log, TEXT("New attack substate: %d"), CurrentSubstate);
-
-	ACSMeleeWeapon* MeleeWeapon = Cast<ACSMeleeWeapon>(Character->GetCurrentWeapon());
-	if (MeleeWeapon)
-	{
-		MeleeWeapon->OnAttackBegin((CharacterSubstateType_Attack)CurrentSubstate);
-	}
 }
 
 void UCSCharacterState_Attack::UpdateState(float DeltaTime)
@@ -133,10 +127,13 @@ void UCSCharacterState_Attack::ExitState()
 
 	Character->SetCanMove(true);
 
-	ACSMeleeWeapon* MeleeWeapon = Cast<ACSMeleeWeapon>(Character->GetCurrentWeapon());
-	if (MeleeWeapon)
+	//An interrupted attack can't be parried anymore
+	Character->SetParriable(false);
+
+	UCSMeleeWeaponComponent* MeleeWeaponComp = Character->GetMeleeWeaponComponent();
+	if (MeleeWeaponComp)
 	{
-		MeleeWeapon->SetDamageEnabled(false);
+		MeleeWeaponComp->SetDamageEnabled(false);
 		//UE_LOG(LogTemp, Log, TEXT("Damage disabled by: %s"), *Character->GetFName().ToString());
 	}
 }
@@ -169,18 +166,18 @@ void UCSCharacterState_Attack::OnAnimationNotify(FString AnimationNotifyName)
 {
 	if (AnimationNotifyName == "EnableDamage")
 	{
-		ACSMeleeWeapon* MeleeWeapon = Cast<ACSMeleeWeapon>(Character->GetCurrentWeapon());
-		if (MeleeWeapon)
+		UCSMeleeWeaponComponent* MeleeWeaponComp = Character->GetMeleeWeaponComponent();
+		if (MeleeWeaponComp)
 		{
-			MeleeWeapon->SetDamageEnabled(true);
+			MeleeWeaponComp->SetDamageEnabled(true);
 		}
 	}
 	else if (AnimationNotifyName == "DisableDamage")
 	{
-		ACSMeleeWeapon* MeleeWeapon = Cast<ACSMeleeWeapon>(Character->GetCurrentWeapon());
-		if (MeleeWeapon)
+		UCSMeleeWeaponComponent* MeleeWeaponComp = Character->GetMeleeWeaponComponent();
+		if (MeleeWeaponComp)
 		{
-			MeleeWeapon->SetDamageEnabled(false);
+			MeleeWeaponComp->SetDamageEnabled(false);
 		}
 	}
 	else if (AnimationNotifyName == "CanChangeAttack")
@@ -190,7 +187,7 @@ void UCSCharacterState_Attack::OnAnimationNotify(FString AnimationNotifyName)
 			CurrentConsecutiveAttacks++;
 			Character->GetStaminaComponent()->ConsumeStamina(StaminaCost);
 			Character->PlayAnimMontage(DefaultAttackAnimMontages[CurrentConsecutiveAttacks]);
-			if (CurrentConsecutiveAttacks < DefaultAttackShakes.Num()) { Character->GetCameraManager()->PlayCameraShake(DefaultAttackShakes[CurrentConsecutiveAttacks], 1.0f); }
+			if (CurrentConsecutiveAttacks < DefaultAttackShakes.Num()) { Character->PlayCameraShake(DefaultAttackShakes[CurrentConsecutiveAttacks], 1.0f); }
 			StateRequested = false;
 		}
 		else if (Character->IsStateRequested(CharacterStateType::DODGE))
@@ -214,7 +211,7 @@ void UCSCharacterState_Attack::OnAnimationNotify(FString AnimationNotifyName)
 
 void UCSCharacterState_Attack::OnEnemyHit()
 {
-	Character->GetCameraManager()->PlayCameraShake(StrikeShake, 0.25f);
+	Character->PlayCameraShake(StrikeShake, 0.25f);
 	Character->PlayForceFeedback(WeaponStrikeForceFeedback);
 	//StartSlowMotion(HitPauseDuration, HitPauseTimeDilation);
 }
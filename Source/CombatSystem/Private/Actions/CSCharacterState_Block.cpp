@@ -5,6 +5,7 @@
 #include "Actions/CSCharacterState_Hit.h"
 #include "CSCharacter.h"
 #include "Components/CSStaminaComponent.h"
+#include "CSDamageEvent.h"
 
 UCSCharacterState_Block::UCSCharacterState_Block() : UCSCharacterState()
 {
@@ -40,10 +41,15 @@ void UCSCharacterState_Block::ExitState()
 	Character->ResetMaxWalkSpeed();
 }
 
-void UCSCharacterState_Block::OnImpact(float& Damage, const UDamageType * DamageType, AController * InstigatedBy, AActor * DamageCauser)
+void UCSCharacterState_Block::OnImpact(float& Damage, const FCSDamageEvent& DamageEvent)
 {
-	float DamageDistance = FVector::Distance(DamageCauser->GetActorLocation(), Character->GetActorLocation());
-	if (Character->IsFacingActor(DamageCauser->GetOwner(), 90.0f) && DamageDistance < 60.0f)
+	//The causer may already be gone or back in its pool when deferred hits are resolved, only the attacker is needed
+	ACSCharacter* Attacker = DamageEvent.Attacker.Get();
+	if (Attacker == nullptr) { return; }
+
+	//Measured from where the weapon or arrow was when the hit was detected, the impact point is always on the body
+	float DamageDistance = FVector::Distance(DamageEvent.DamageCauserLocation, Character->GetActorLocation());
+	if (Character->IsFacingActor(Attacker, 90.0f) && DamageDistance < 60.0f)
 	{
 		float BlockingStaminaCost = StaminaCostPerDamagePoint * Damage;
 
@@ -52,7 +58,7 @@ void UCSCharacterState_Block::OnImpact(float& Damage, const UDamageType * Damage
 		{
 			Character->PlayAnimMontage(BlockImpactMontage, MontageSpeed);
 			
-			FVector ImpactDirection = (DamageCauser->GetOwner()->GetActorLocation() - Character->GetActorLocation()).GetSafeNormal();
+			FVector ImpactDirection = (Attacker->GetActorLocation() - Character->GetActorLocation()).GetSafeNormal();
 			Character->SetActorLocation(Character->GetActorLocation() + ImpactDirection * -ImpactMovementForce);
 			if (BlockImpactForceFeedback) { Character->PlayForceFeedback(BlockImpactForceFeedback); }
 			//Character->LaunchCharacter(-ImpactDirection * ImpactMovementForce, true, true);
@@ -6,9 +6,11 @@
 #include "GameFramework/PawnMovementComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Components/CapsuleComponent.h"
+#include "Subsystems/CSRagdollSubsystem.h"
 
 #include "Kismet/GameplayStatics.h"
 #include "CSGameMode.h"
+#include "../../CombatSystem.h"
 
 UCSCharacterState_Dead::UCSCharacterState_Dead() : UCSCharacterState()
 {
@@ -29,7 +31,7 @@ void UCSCharacterState_Dead::EnterState(uint8 NewSubstate)
 	Character->GetCharacterMovement()->MovementMode = EMovementMode::MOVE_None;
 	Character->GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 
-	Character->OnSetAsTarget(false);
+	Character->SetUITarget(false);
 
 	ACSGameMode* GameMode = Cast<ACSGameMode>(UGameplayStatics::GetGameMode(GetWorld()));
 	if (GameMode)
@@ -48,6 +50,14 @@ void UCSCharacterState_Dead::OnAnimationNotify(FString AnimationNotifyName)
 {
 	if (AnimationNotifyName == "DeadEnd")
 	{
-		Character->GetMesh()->SetSimulatePhysics(true);
+		UCSRagdollSubsystem* RagdollSubsystem = GetWorld()->GetSubsystem<UCSRagdollSubsystem>();
+		if (RagdollSubsystem)
+		{
+			RagdollSubsystem->AddRagdoll(Character->GetMesh());
+		}
+		else if (CSAreCosmeticsEnabled(GetWorld()))
+		{
+			Character->GetMesh()->SetSimulatePhysics(true);
+		}
 	}
 }
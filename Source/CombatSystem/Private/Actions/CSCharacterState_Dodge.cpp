@@ -46,7 +46,7 @@ void UCSCharacterState_Dodge::EnterState(uint8 NewSubstate)
 		//DodgeDirection = Character->GetActorForwardVector().GetSafeNormal();
 	}
 
-	Character->GetCameraManager()->PlayCameraShake(DodgeShake, 0.5f);
+	Character->PlayCameraShake(DodgeShake, 0.5f);
 	Character->PlayForceFeedback(DodgeForceFeedback);
 
 	//Character->SetActorRotation(DodgeDirection.ToOrientationRotator());
@@ -5,6 +5,7 @@
 #include "CSCharacter.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Components/CSCameraManagerComponent.h"
+#include "Subsystems/CSCombatAudioSubsystem.h"
 #include "Kismet/GameplayStatics.h"
 #include "Kismet/KismetMathLibrary.h"
 
@@ -21,12 +22,12 @@ void UCSCharacterState_Hit::EnterState(uint8 NewSubstate)
 
 	Character->SetCanMove(false);
 
-	Character->OnHit();
+	Character->NotifyUIHit();
 
 	FVector BackwardVector = -Character->GetActorForwardVector();
 	Character->SetActorLocation(Character->GetActorLocation() + BackwardVector * RecoilForce);
 
-	Character->GetCameraManager()->PlayCameraShake(HitShake, 0.5f);
+	Character->PlayCameraShake(HitShake, 0.5f);
 
 	float DamageOriginDot = FVector::DotProduct(Character->GetActorForwardVector(), DamageOrigin - Character->GetActorLocation());
 	switch (CurrentSubstate)
@@ -59,10 +60,11 @@ void UCSCharacterState_Hit::EnterState(uint8 NewSubstate)
 		break;
 	}
 
-	if (!HitSounds.IsEmpty())
+	UCSCombatAudioSubsystem* CombatAudio = GetWorld()->GetSubsystem<UCSCombatAudioSubsystem>();
+	if (!HitSounds.IsEmpty() && CombatAudio && Character->GetCosmeticDetail() == CSCosmeticDetail::FULL)
 	{
 		int RandomHitSound = FMath::RandRange(0, HitSounds.Num() - 1);
-		UGameplayStatics::PlaySoundAtLocation(GetWorld(), HitSounds[RandomHitSound], Character->GetActorLocation());
+		CombatAudio->PlayCombatSound(HitSounds[RandomHitSound], Character->GetActorLocation(), CSCombatSoundCategory::HIT_REACTION, Character);
 	}
 
 	Character->PlayForceFeedback(HitForceFeedback);
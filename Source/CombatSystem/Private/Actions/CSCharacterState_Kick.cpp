@@ -7,7 +7,8 @@
 #include "Components/CSCameraManagerComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "Components/CSStaminaComponent.h"
-#include "NiagaraFunctionLibrary.h"
+#include "Subsystems/CSImpactEffectSubsystem.h"
+#include "Subsystems/CSCombatAudioSubsystem.h"
 
 UCSCharacterState_Kick::UCSCharacterState_Kick() : UCSCharacterState()
 {
@@ -48,17 +49,18 @@ void UCSCharacterState_Kick::OnAnimationNotify(FString AnimationNotifyName)
 
 		if (KickedCharacters.Num() > 0)
 		{
-			Character->GetCameraManager()->PlayCameraShake(KickImpactShake, 0.5f);
+			Character->PlayCameraShake(KickImpactShake, 0.5f);
 		}
 
 		for (size_t i = 0; i < KickedCharacters.Num(); ++i)
 		{
 			//UE_LOG(LogTemp, Warning, TEXT("Kicked character: %s"), *KickedCharacters[i]->GetName());
-			UCSCharacterState_Hit* HitState = Cast<UCSCharacterState_Hit>(KickedCharacters[i]->GetCharacterState(CharacterStateType::HIT));
+			UCSCharacterState_Hit* HitState = KickedCharacters[i]->GetHitState();
 			if (HitState)
 			{
-				if (KickImpactEffect) {
-					UNiagaraFunctionLibrary::SpawnSystemAtLocation(GetWorld(), KickImpactEffect, Character->GetMesh()->GetSocketLocation(FootSocketName));
+				UCSImpactEffectSubsystem* ImpactEffects = GetWorld()->GetSubsystem<UCSImpactEffectSubsystem>();
+				if (KickImpactEffect && ImpactEffects && Character->GetCosmeticDetail(KickedCharacters[i]) != CSCosmeticDetail::NONE) {
+					ImpactEffects->SpawnImpactEffect(KickImpactEffect, Character->GetMesh()->GetSocketLocation(FootSocketName));
 				}
 				HitState->OnCharacterKicked(Character, Character->GetActorForwardVector() * KickForce);
 				CharacterKicked = true;
@@ -70,7 +72,8 @@ void UCSCharacterState_Kick::OnAnimationNotify(FString AnimationNotifyName)
 	if (CharacterKicked)
 	{
 		Character->PlayForceFeedback(KickForceFeedback);
-		if (KickImpactSound) { UGameplayStatics::PlaySoundAtLocation(GetWorld(), KickImpactSound, Character->GetActorLocation()); }
+		UCSCombatAudioSubsystem* CombatAudio = GetWorld()->GetSubsystem<UCSCombatAudioSubsystem>();
+		if (KickImpactSound && CombatAudio && Character->GetCosmeticDetail() == CSCosmeticDetail::FULL) { CombatAudio->PlayCombatSound(KickImpactSound, Character->GetActorLocation(), CSCombatSoundCategory::IMPACT, Character); }
 		StartSlowMotion(HitPauseDuration, HitPauseTimeDilation);
 	}
 	else
@@ -92,7 +95,7 @@ TArray<ACSCharacter*> UCSCharacterState_Kick::DetectKickedCharacters()
 	QueryParams.AddObjectTypesToQuery(ECC_Pawn);
 
 	TArray<FOverlapResult> Overlaps;
-	GetWorld()->OverlapMultiByObjectType(Overlaps, Character->GetMesh()->GetSocketLocation(FootSocketName), FQuat::Identity, QueryParams, CollShape);
+	GetWorld()->OverlapMultiByObjectType(Overlaps, Character->GetCombatSocketTransform(FootSocketName).GetLocation(), FQuat::Identity, QueryParams, CollShape);
 
 	//DrawDebugSphere(GetWorld(), Character->GetMesh()->GetSocketLocation(FootSocketName), KickedEnemiesDetectionSphereRadius, 12, FColor::Red, false, 1.0f);
 
@@ -4,7 +4,8 @@
 #include "CSCharacter.h"
 #include "Components/CSCameraManagerComponent.h"
 #include "Actions/CSCharacterState_Hit.h"
-#include "NiagaraFunctionLibrary.h"
+#include "Subsystems/CSParryWindowRegistry.h"
+#include "Subsystems/CSImpactEffectSubsystem.h"
 
 UCSCharacterState_Parry::UCSCharacterState_Parry() : UCSCharacterState()
 {
@@ -28,31 +29,6 @@ void UCSCharacterState_Parry::EnterState(uint8 NewSubstate)
 
 void UCSCharacterState_Parry::UpdateState(float DeltaTime)
 {
-	if (CanParry)
-	{
-		TArray<ACharacter*> NearbyEnemies = Character->GetNearbyEnemies();
-		if (NearbyEnemies.Num() > 0)
-		{
-			ACharacter* ClosestFacingCharacter = GetNearestFacingEnemy(NearbyEnemies, ParryRange);
-			if (ClosestFacingCharacter)
-			{
-				ACSCharacter* CharacterToParry = Cast<ACSCharacter>(ClosestFacingCharacter);
-				if (CharacterToParry->IsParriable())
-				{
-					UE_LOG(LogTemp, Log, TEXT("Parriable: %s"), *ClosestFacingCharacter->GetFName().ToString());
-					CharacterToParry->ChangeState(CharacterStateType::HIT, (uint8)CharacterSubstateType_Hit::PARRIED_HIT);
-					CanParry = false;
-					CharacterParried = true;
-					ParriedCharacterPosition = CharacterToParry->GetActorLocation();
-					if (ParryImpactEffect)
-					{
-						UNiagaraFunctionLibrary::SpawnSystemAtLocation(GetWorld(), ParryImpactEffect, Character->GetMesh()->GetSocketLocation(ParticlesSocketName));
-					}
-				}
-			}
-		}
-	}
-
 	if (CharacterParried)
 	{
 		float Distance = (ParriedCharacterPosition - Character->GetActorLocation()).Length();
@@ -70,17 +46,24 @@ void UCSCharacterState_Parry::ExitState()
 	Super::ExitState();
 
 	Character->SetCanMove(true);
+
+	UCSParryWindowRegistry* ParryRegistry = GetWorld()->GetSubsystem<UCSParryWindowRegistry>();
+	if (ParryRegistry) { ParryRegistry->EndParry(Character); }
 }
 
 void UCSCharacterState_Parry::OnAnimationNotify(FString AnimationNotifyName)
 {
+	UCSParryWindowRegistry* ParryRegistry = GetWorld()->GetSubsystem<UCSParryWindowRegistry>();
+
 	if (AnimationNotifyName == "EnableParry")
 	{
 		CanParry = true;
+		if (ParryRegistry) { ParryRegistry->BeginParry(Character, this, ParryRange); }
 	}
 	else if (AnimationNotifyName == "DisableParry")
 	{
 		CanParry = false;
+		if (ParryRegistry) { ParryRegistry->EndParry(Character); }
 	}
 	else if (AnimationNotifyName == "ParryBlockEnd")
 	{
@@ -91,6 +74,29 @@ void UCSCharacterState_Parry::OnAnimationNotify(FString AnimationNotifyName)
 	}
 	else if (AnimationNotifyName == "ParryImpact")
 	{
-		Character->GetCameraManager()->PlayCameraShake(ImpactShake, 1.0f);
+		Character->PlayCameraShake(ImpactShake, 1.0f);
+	}
+}
+
+void UCSCharacterState_Parry::OnParrySucceeded(ACSCharacter* ParriedCharacter)
+{
+	if (!CanParry || CharacterParried || ParriedCharacter == nullptr) { return; }
+
+	UE_LOG(LogTemp, Log, TEXT("Parriable: %s"), *ParriedCharacter->GetFName().ToString());
+	ParriedCharacter->ChangeState(CharacterStateType::HIT, (uint8)CharacterSubstateType_Hit::PARRIED_HIT);
+	CanParry = false;
+	CharacterParried = true;
+	ParriedCharacterPosition = ParriedCharacter->GetActorLocation();
+	UCSImpactEffectSubsystem* ImpactEffects = GetWorld()->GetSubsystem<UCSImpactEffectSubsystem>();
+	if (ParryImpactEffect && ImpactEffects && Character->GetCosmeticDetail(ParriedCharacter) != CSCosmeticDetail::NONE)
+	{
+		ImpactEffects->SpawnImpactEffect(ParryImpactEffect, Character->GetMesh()->GetSocketLocation(ParticlesSocketName));
 	}
-}
\ No newline at end of file
+
+	UCSParryWindowRegistry* ParryRegistry = GetWorld()->GetSubsystem<UCSParryWindowRegistry>();
+	if (ParryRegistry)
+	{
+		ParryRegistry->EndParry(Character);
+		ParryRegistry->CloseParryWindow(ParriedCharacter);
+	}
+}
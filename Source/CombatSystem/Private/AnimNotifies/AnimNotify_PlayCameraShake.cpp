@@ -3,6 +3,8 @@
 
 #include "AnimNotifies/AnimNotify_PlayCameraShake.h"
 
+#include "GameFramework/PlayerController.h"
+
 UAnimNotify_PlayCameraShake::UAnimNotify_PlayCameraShake() : Super()
 {}
 
@@ -14,8 +16,9 @@ void UAnimNotify_PlayCameraShake::Notify(USkeletalMeshComponent* MeshComp, UAnim
 	if (!Owner) { return; }
 	
 	APawn* PawnOwner = Cast<APawn>(Owner);
-	if (PawnOwner && PawnOwner->IsPlayerControlled())
+	APlayerController* PlayerController = PawnOwner ? Cast<APlayerController>(PawnOwner->GetController()) : nullptr;
+	if (PlayerController && PlayerController->IsLocalController())
 	{
-		GetWorld()->GetFirstPlayerController()->ClientStartCameraShake(CameraShake, Scale);
+		PlayerController->ClientStartCameraShake(CameraShake, Scale);
 	}
 }
\ No newline at end of file
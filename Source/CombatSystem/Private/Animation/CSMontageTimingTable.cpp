@@ -0,0 +1,145 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Animation/CSMontageTimingTable.h"
+
+#include "Animation/AnimMontage.h"
+#include "Animation/AnimSequence.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/SkeletalMeshSocket.h"
+
+bool FCSMontageTiming::SampleSocket(FName SocketName, float Time, FTransform& OutTransform) const
+{
+	const FCSMontageSocketTrack* Track = SocketTracks.FindByPredicate([SocketName](const FCSMontageSocketTrack& Other) { return Other.SocketName == SocketName; });
+	if (Track == nullptr || Track->Samples.Num() == 0) { return false; }
+
+	float SamplePosition = FMath::Clamp(Time * SampleRate, 0.0f, (float)(Track->Samples.Num() - 1));
+	int32 FirstSample = FMath::FloorToInt(SamplePosition);
+	int32 SecondSample = FMath::Min(FirstSample + 1, Track->Samples.Num() - 1);
+
+	OutTransform.Blend(Track->Samples[FirstSample], Track->Samples[SecondSample], SamplePosition - FirstSample);
+	return true;
+}
+
+UCSMontageTimingTable::UCSMontageTimingTable()
+{
+	SkeletalMesh = nullptr;
+	SampleRate = 30.0f;
+
+	SampledSockets.Add("WeaponSocket");
+}
+
+const FCSMontageTiming* UCSMontageTimingTable::FindTiming(const UAnimMontage* Montage) const
+{
+	return Timings.Find(Montage);
+}
+
+#if WITH_EDITOR
+void UCSMontageTimingTable::RebuildTimings()
+{
+	Timings.Reset();
+
+	for (UAnimMontage* Montage : Montages)
+	{
+		if (Montage == nullptr) { continue; }
+
+		FCSMontageTiming Timing;
+		if (BuildTiming(Montage, Timing))
+		{
+			Timings.Add(Montage, MoveTemp(Timing));
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Could not build the timings of %s in %s"), *Montage->GetName(), *GetName());
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Built the timings of %d montages in %s"), Timings.Num(), *GetName());
+
+	MarkPackageDirty();
+}
+
+bool UCSMontageTimingTable::BuildTiming(UAnimMontage* Montage, FCSMontageTiming& OutTiming) const
+{
+	if (Montage->SlotAnimTracks.Num() == 0) { return false; }
+
+	OutTiming.Length = Montage->GetPlayLength();
+	OutTiming.SampleRate = FMath::Max(SampleRate, 1.0f);
+
+	//Only the named notifies handled by the animation blueprint drive gameplay, notify classes are cosmetic
+	for (const FAnimNotifyEvent& NotifyEvent : Montage->Notifies)
+	{
+		if (NotifyEvent.Notify || NotifyEvent.NotifyStateClass || NotifyEvent.NotifyName.IsNone()) { continue; }
+
+		FCSMontageNotifyTiming& NotifyTiming = OutTiming.Notifies.AddDefaulted_GetRef();
+		NotifyTiming.NotifyName = NotifyEvent.NotifyName;
+		NotifyTiming.Time = NotifyEvent.GetTriggerTime();
+	}
+
+	OutTiming.Notifies.StableSort([](const FCSMontageNotifyTiming& A, const FCSMontageNotifyTiming& B) { return A.Time < B.Time; });
+
+	if (SkeletalMesh == nullptr) { return true; }
+
+	int32 NumSamples = FMath::FloorToInt(OutTiming.Length * OutTiming.SampleRate) + 1;
+	for (FName SocketName : SampledSockets)
+	{
+		FCSMontageSocketTrack Track;
+		Track.SocketName = SocketName;
+		Track.Samples.Reserve(NumSamples);
+
+		for (int32 i = 0; i < NumSamples; ++i)
+		{
+			float Time = FMath::Min(i / OutTiming.SampleRate, OutTiming.Length);
+
+			FTransform SocketTransform;
+			if (!GetSocketTransformAtTime(Montage, SocketName, Time, SocketTransform)) { break; }
+			Track.Samples.Add(SocketTransform);
+		}
+
+		if (Track.Samples.Num() == NumSamples)
+		{
+			OutTiming.SocketTracks.Add(MoveTemp(Track));
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Could not sample socket %s of %s"), *SocketName.ToString(), *Montage->GetName());
+		}
+	}
+
+	return true;
+}
+
+bool UCSMontageTimingTable::GetSocketTransformAtTime(UAnimMontage* Montage, FName SocketName, float Time, FTransform& OutTransform) const
+{
+	const FAnimSegment* Segment = Montage->SlotAnimTracks[0].AnimTrack.GetSegmentAtTime(Time);
+	const UAnimSequence* Sequence = Segment ? Cast<UAnimSequence>(Segment->GetAnimReference()) : nullptr;
+	if (Sequence == nullptr) { return false; }
+
+	const USkeletalMeshSocket* Socket = SkeletalMesh->FindSocket(SocketName);
+	const USkeleton* Skeleton = Montage->GetSkeleton();
+	if (Socket == nullptr || Skeleton == nullptr) { return false; }
+
+	const FReferenceSkeleton& RefSkeleton = SkeletalMesh->GetRefSkeleton();
+	int32 BoneIndex = RefSkeleton.FindBoneIndex(Socket->BoneName);
+	if (BoneIndex == INDEX_NONE) { return false; }
+
+	float AnimTime = Segment->ConvertTrackPosToAnimPos(Time);
+
+	//Compose the local bone transforms from the socket bone up to the root
+	OutTransform = Socket->GetSocketLocalTransform();
+	while (BoneIndex != INDEX_NONE)
+	{
+		FTransform BoneTransform = RefSkeleton.GetRefBonePose()[BoneIndex];
+
+		int32 SkeletonBoneIndex = Skeleton->GetSkeletonBoneIndexFromMeshBoneIndex(SkeletalMesh, BoneIndex);
+		if (SkeletonBoneIndex != INDEX_NONE)
+		{
+			Sequence->GetBoneTransform(BoneTransform, FSkeletonPoseBoneIndex(SkeletonBoneIndex), AnimTime, false);
+		}
+
+		OutTransform = OutTransform * BoneTransform;
+		BoneIndex = RefSkeleton.GetParentIndex(BoneIndex);
+	}
+
+	return true;
+}
+#endif
@@ -0,0 +1,11 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CSAICharacter.h"
+
+ACSAICharacter::ACSAICharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer
+		.DoNotCreateDefaultSubobject(TEXT("SpringArmComp"))
+		.DoNotCreateDefaultSubobject(TEXT("CameraComp"))
+		.DoNotCreateDefaultSubobject(TEXT("CameraManagerComp")))
+{
+}
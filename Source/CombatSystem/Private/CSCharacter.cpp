@@ -6,9 +6,12 @@
 #include "GameFramework/SpringArmComponent.h"
 #include "Components/SphereComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "Components/CapsuleComponent.h"
 #include "Runtime/Engine/Classes/Kismet/GameplayStatics.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "GameFramework/Controller.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
 #include "DrawDebugHelpers.h"
 
 #include "CSWeapon.h"
@@ -20,12 +23,22 @@
 #include "Components/CSHealthComponent.h"
 #include "Components/CSStaminaComponent.h"
 #include "Components/CSCameraManagerComponent.h"
+#include "Components/CSHitboxComponent.h"
+#include "Components/CSMontageTimelineComponent.h"
+#include "Components/CSProjectileNetComponent.h"
+#include "Components/CSMeleeWeaponComponent.h"
 
 #include "Actions/CSCharacterState_Hit.h"
 #include "Actions/CSCharacterState_Attack.h"
 #include "Actions/CSCharacterState_Block.h"
 
-#include "NiagaraFunctionLibrary.h"
+#include "Subsystems/CSParryWindowRegistry.h"
+#include "Subsystems/CSCharacterRegistry.h"
+#include "Subsystems/CSImpactEffectSubsystem.h"
+#include "Subsystems/CSRagdollSubsystem.h"
+#include "CSDamageEvent.h"
+#include "../CombatSystem.h"
+
 
 static int32 GenericDebugDraw = 0;
 FAutoConsoleVariableRef CVARGenericDebugDraw(
@@ -34,6 +47,38 @@ FAutoConsoleVariableRef CVARGenericDebugDraw(
 	TEXT("Draw all genric debug"),
 	ECVF_Cheat);
 
+static int32 LegacyUIEvents = 1;
+FAutoConsoleVariableRef CVARLegacyUIEvents(
+	TEXT("CS.LegacyUIEvents"),
+	LegacyUIEvents,
+	TEXT("Also send the UI model changes to the old UpdateHealth, UpdateStamina, OnSetAsTarget, SetCrosshairActive and OnHit blueprint events, once per frame"),
+	ECVF_Cheat);
+
+static int32 CosmeticCulling = 1;
+FAutoConsoleVariableRef CVARCosmeticCulling(
+	TEXT("CS.CosmeticCulling"),
+	CosmeticCulling,
+	TEXT("Skip or reduce the cosmetic feedback of exchanges that no local player is involved in and that are off screen or far"),
+	ECVF_Cheat);
+
+static float CosmeticCullDistance = 6000.0f;
+FAutoConsoleVariableRef CVARCosmeticCullDistance(
+	TEXT("CS.CosmeticCullDistance"),
+	CosmeticCullDistance,
+	TEXT("Distance to the closest local view where the cosmetic significance of an exchange reaches 0"),
+	ECVF_Cheat);
+
+static float CosmeticFullDetailSignificance = 0.5f;
+FAutoConsoleVariableRef CVARCosmeticFullDetailSignificance(
+	TEXT("CS.CosmeticFullDetailSignificance"),
+	CosmeticFullDetailSignificance,
+	TEXT("Exchanges below this significance only play their main impact effect"),
+	ECVF_Cheat);
+
+DECLARE_MEMORY_STAT(TEXT("Camera Components Memory (Estimated)"), STAT_CSCameraComponentsMemory, STATGROUP_CombatSystem);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Characters With Camera"), STAT_CSCharactersWithCamera, STATGROUP_CombatSystem);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Characters Without Camera"), STAT_CSCharactersWithoutCamera, STATGROUP_CombatSystem);
+
 static int32 DebugDetectionDrawing = 0;
 FAutoConsoleVariableRef CVARDebugDetectionDrawing(
 	TEXT("CS.DebugDetectionDrawing"),
@@ -42,18 +87,27 @@ FAutoConsoleVariableRef CVARDebugDetectionDrawing(
 	ECVF_Cheat);
 
 // Sets default values
-ACSCharacter::ACSCharacter()
+ACSCharacter::ACSCharacter(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
-	SpringArmComp = CreateDefaultSubobject<USpringArmComponent>(TEXT("SpringArmComp"));
-	SpringArmComp->SetupAttachment(RootComponent);
-	SpringArmComp->bUsePawnControlRotation = true;
+	//Optional so characters that are never viewed through, like the AI, can skip them. Servers never view through any
+#if CS_WITH_COSMETICS
+	SpringArmComp = CreateOptionalDefaultSubobject<USpringArmComponent>(TEXT("SpringArmComp"));
+	if (SpringArmComp)
+	{
+		SpringArmComp->SetupAttachment(RootComponent);
+		SpringArmComp->bUsePawnControlRotation = true;
+	}
 
-	CameraComp = CreateDefaultSubobject<UCameraComponent>(TEXT("CameraComp"));
-	CameraComp->SetupAttachment(SpringArmComp);
-	CameraComp->bUsePawnControlRotation = false;
+	CameraComp = CreateOptionalDefaultSubobject<UCameraComponent>(TEXT("CameraComp"));
+	if (CameraComp)
+	{
+		CameraComp->SetupAttachment(SpringArmComp ? (USceneComponent*)SpringArmComp : RootComponent);
+		CameraComp->bUsePawnControlRotation = false;
+	}
+#endif
 
 	bUseControllerRotationPitch = false;
 	bUseControllerRotationYaw = false;
@@ -64,7 +118,13 @@ ACSCharacter::ACSCharacter()
 
 	HealthComp = CreateDefaultSubobject<UCSHealthComponent>(TEXT("HealthComp"));
 	StaminaComp = CreateDefaultSubobject<UCSStaminaComponent>(TEXT("StaminaComp"));
-	CameraManagerComp = CreateDefaultSubobject<UCSCameraManagerComponent>(TEXT("CameraManagerComp"));
+#if CS_WITH_COSMETICS
+	CameraManagerComp = CreateOptionalDefaultSubobject<UCSCameraManagerComponent>(TEXT("CameraManagerComp"));
+#endif
+	HitboxComp = CreateDefaultSubobject<UCSHitboxComponent>(TEXT("HitboxComp"));
+	MontageTimelineComp = CreateDefaultSubobject<UCSMontageTimelineComponent>(TEXT("MontageTimelineComp"));
+	ProjectileNetComp = CreateDefaultSubobject<UCSProjectileNetComponent>(TEXT("ProjectileNetComp"));
+	MeleeWeaponComp = CreateDefaultSubobject<UCSMeleeWeaponComponent>(TEXT("MeleeWeaponComp"));
 
 	CanMove = true;
 
@@ -90,6 +150,15 @@ ACSCharacter::ACSCharacter()
 	JogSpeed = 400.0f;
 	RunSpeed = 600.0f;
 	LockedSpeed = 250.0f;
+
+	MaxParryWindowDuration = 1.0f;
+
+	HitState = nullptr;
+	BlockState = nullptr;
+
+	PendingLegacyUIChanges = CSUIModelField::NONE;
+
+	CameraComponentsMemory = 0;
 }
 
 // Called when the game starts or when spawned
@@ -100,10 +169,6 @@ void ACSCharacter::BeginPlay()
 	GetCharacterMovement()->MaxWalkSpeed = JogSpeed;
 
 	SpawnEquipment();
-	if (CurrentRangedWeapon)
-	{
-		CurrentRangedWeapon->SetHidden(true);
-	}
 
 	//Check for enemies every certainm time
 	if (IsPlayerControlled())
@@ -112,8 +177,6 @@ void ACSCharacter::BeginPlay()
 		GetWorldTimerManager().SetTimer(TimerHandle_CheckNearbyEnemies, this, &ACSCharacter::OnDetectNearbyEnemies, 0.5f, true);
 	}
 
-	HealthComp->OnHealthChanged.AddDynamic(this, &ACSCharacter::OnHealthChanged);
-
 	//States setup
 	for (TSubclassOf<UCSCharacterState> StateClass : DefaultStates)
 	{
@@ -124,6 +187,32 @@ void ACSCharacter::BeginPlay()
 	{
 		CurrentState = LastState = CharacterStateType::DEFAULT;
 	}
+
+	UCSCharacterRegistry* CharacterRegistry = GetWorld()->GetSubsystem<UCSCharacterRegistry>();
+	if (CharacterRegistry) { CharacterRegistry->RegisterCharacter(this); }
+
+	//Per character footprint of the camera components, characters without them add nothing.
+	//Estimated total counts the objects with what they allocate, such as arrays and subobjects, not only their class size
+	CameraComponentsMemory = 0;
+	if (SpringArmComp) { CameraComponentsMemory += SpringArmComp->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal); }
+	if (CameraComp) { CameraComponentsMemory += CameraComp->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal); }
+	if (CameraManagerComp) { CameraComponentsMemory += CameraManagerComp->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal); }
+
+	INC_MEMORY_STAT_BY(STAT_CSCameraComponentsMemory, CameraComponentsMemory);
+	if (CameraComponentsMemory > 0) { INC_DWORD_STAT(STAT_CSCharactersWithCamera); }
+	else { INC_DWORD_STAT(STAT_CSCharactersWithoutCamera); }
+}
+
+void ACSCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UCSCharacterRegistry* CharacterRegistry = GetWorld()->GetSubsystem<UCSCharacterRegistry>();
+	if (CharacterRegistry) { CharacterRegistry->UnregisterCharacter(this); }
+
+	DEC_MEMORY_STAT_BY(STAT_CSCameraComponentsMemory, CameraComponentsMemory);
+	if (CameraComponentsMemory > 0) { DEC_DWORD_STAT(STAT_CSCharactersWithCamera); }
+	else { DEC_DWORD_STAT(STAT_CSCharactersWithoutCamera); }
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void ACSCharacter::StartDestroy()
@@ -133,9 +222,9 @@ void ACSCharacter::StartDestroy()
 		CurrentWeapon->Destroy();
 	}
 
-	if (CurrentShield != nullptr)
+	if (ShieldMeshComp != nullptr)
 	{
-		CurrentShield->Destroy();
+		ShieldMeshComp->DestroyComponent();
 	}
 
 	if (CurrentRangedWeapon != nullptr)
@@ -143,12 +232,125 @@ void ACSCharacter::StartDestroy()
 		CurrentRangedWeapon->Destroy();
 	}
 
-	if (DestroyNiagaraSystem != nullptr)
+	PlayDestroyEffect();
+
+	Destroy();
+}
+
+void ACSCharacter::PlayDestroyEffect()
+{
+	UCSImpactEffectSubsystem* ImpactEffects = GetWorld()->GetSubsystem<UCSImpactEffectSubsystem>();
+	if (DestroyNiagaraSystem != nullptr && ImpactEffects && GetCosmeticDetail() != CSCosmeticDetail::NONE)
 	{
-		UNiagaraFunctionLibrary::SpawnSystemAtLocation(GetWorld(), DestroyNiagaraSystem, GetActorLocation());
+		ImpactEffects->SpawnEssentialEffect(DestroyNiagaraSystem, GetActorLocation());
 	}
+}
 
-	Destroy();
+void ACSCharacter::DeactivateCharacter()
+{
+	UnlockTarget();
+	SetParriable(false);
+	StopAnimMontage();
+
+	UCSCharacterRegistry* CharacterRegistry = GetWorld()->GetSubsystem<UCSCharacterRegistry>();
+	if (CharacterRegistry) { CharacterRegistry->UnregisterCharacter(this); }
+
+	UCSRagdollSubsystem* RagdollSubsystem = GetWorld()->GetSubsystem<UCSRagdollSubsystem>();
+	if (RagdollSubsystem) { RagdollSubsystem->RemoveRagdoll(GetMesh()); }
+
+	//Nothing of a deactivated character may fire later, such as the next frame UI events
+	GetWorldTimerManager().ClearAllTimersForObject(this);
+	TimerHandle_LegacyUIEvents.Invalidate();
+	PendingLegacyUIChanges = CSUIModelField::NONE;
+
+	//Components and states set their timers on themselves, such as the regeneration notifications or the state requests
+	GetWorldTimerManager().ClearAllTimersForObject(HealthComp);
+	GetWorldTimerManager().ClearAllTimersForObject(StaminaComp);
+	for (const TPair<CharacterStateType, UCSCharacterState*>& State : States)
+	{
+		if (State.Value) { GetWorldTimerManager().ClearAllTimersForObject(State.Value); }
+	}
+
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->DisableMovement();
+	GetCharacterMovement()->SetComponentTickEnabled(false);
+	GetMesh()->SetSimulatePhysics(false);
+	GetMesh()->SetComponentTickEnabled(false);
+
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+
+	//Equipment is kept attached for the next time the character is used
+	MeleeWeaponComp->SetDamageEnabled(false);
+	if (CurrentWeapon) { CurrentWeapon->SetActorHiddenInGame(true); }
+	if (ShieldMeshComp) { ShieldMeshComp->SetVisibility(false); }
+	if (CurrentRangedWeapon) { CurrentRangedWeapon->SetActorHiddenInGame(true); }
+}
+
+void ACSCharacter::ResetCharacter(const FTransform& NewTransform)
+{
+	const ACSCharacter* Defaults = GetClass()->GetDefaultObject<ACSCharacter>();
+
+	UCSRagdollSubsystem* RagdollSubsystem = GetWorld()->GetSubsystem<UCSRagdollSubsystem>();
+	if (RagdollSubsystem) { RagdollSubsystem->RemoveRagdoll(GetMesh()); }
+
+	StopAnimMontage();
+
+	//Mesh back on the capsule, ragdolls leave it wherever the bodies fell
+	USkeletalMeshComponent* MeshComp = GetMesh();
+	MeshComp->SetSimulatePhysics(false);
+	MeshComp->AttachToComponent(GetCapsuleComponent(), FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+	MeshComp->SetRelativeLocationAndRotation(GetBaseTranslationOffset(), GetBaseRotationOffset());
+	MeshComp->SetCollisionEnabled(Defaults->GetMesh()->GetCollisionEnabled());
+	MeshComp->bPauseAnims = false;
+	MeshComp->SetComponentTickEnabled(true);
+
+	GetCapsuleComponent()->SetCollisionEnabled(Defaults->GetCapsuleComponent()->GetCollisionEnabled());
+
+	SetActorTransform(NewTransform, false, nullptr, ETeleportType::ResetPhysics);
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	SetActorTickEnabled(true);
+
+	UCharacterMovementComponent* MovementComp = GetCharacterMovement();
+	MovementComp->SetComponentTickEnabled(true);
+	MovementComp->StopMovementImmediately();
+	MovementComp->SetMovementMode(EMovementMode::MOVE_Walking);
+
+	UnlockTarget();
+	CanChangeLockedEnemy = true;
+	CanMove = true;
+	IsRunning = false;
+	ResetMaxWalkSpeed();
+	SetParriable(false);
+
+	HealthComp->ResetHealth();
+	StaminaComp->ResetStamina();
+
+	//Forced, the states never let a character leave DEAD on its own
+	if (States.Contains(CurrentState)) { States[CurrentState]->ExitState(); }
+	for (const TPair<CharacterStateType, UCSCharacterState*>& State : States)
+	{
+		State.Value->DeleteStateRequest();
+	}
+
+	if (States.Contains(CharacterStateType::DEFAULT))
+	{
+		CurrentState = LastState = CharacterStateType::DEFAULT;
+		States[CharacterStateType::DEFAULT]->EnterState();
+	}
+
+	CurrentCombatType = CSCombatType::MELEE;
+	ChangeCombatType(CurrentCombatType);
+
+	SetUIHealth(HealthComp->GetHealthPercentage());
+	SetUIStamina(StaminaComp->GetStaminaPercentage());
+	SetUITarget(false);
+	SetUICrosshairActive(false);
+
+	UCSCharacterRegistry* CharacterRegistry = GetWorld()->GetSubsystem<UCSCharacterRegistry>();
+	if (CharacterRegistry) { CharacterRegistry->RegisterCharacter(this); }
 }
 
 void ACSCharacter::MoveForward(float Value)
@@ -179,7 +381,7 @@ void ACSCharacter::MoveRight(float Value)
 
 void ACSCharacter::Turn(float Value)
 {
-	AddControllerYawInput(Value * CameraManagerComp->GetTurnSpeed());
+	AddControllerYawInput(CameraManagerComp ? Value * CameraManagerComp->GetTurnSpeed() : Value);
 
 	if (CanChangeLockedEnemy && TargetLocked && Value != 0.0f)
 	{
@@ -189,7 +391,7 @@ void ACSCharacter::Turn(float Value)
 
 void ACSCharacter::LookUp(float Value)
 {
-	AddControllerPitchInput(Value * CameraManagerComp->GetLookUpSpeed());
+	AddControllerPitchInput(CameraManagerComp ? Value * CameraManagerComp->GetLookUpSpeed() : Value);
 }
 
 void ACSCharacter::TurnAtRate(float Rate)
@@ -241,8 +443,7 @@ void ACSCharacter::StopRunning()
 	}
 }
 
-void ACSCharacter::OnHealthChanged(UCSHealthComponent* HealthComponent, float CurrentHealth, float HealthDelta,
-	const UDamageType* DamageType, AController* InstigatedBy, AActor* DamageCauser)
+void ACSCharacter::OnHealthChanged(const FCSDamageEvent& DamageEvent, float CurrentHealth)
 {
 	//UE_LOG(LogTemp, Log, TEXT("Current health: %.2f"), CurrentHealth);
 
@@ -255,7 +456,7 @@ void ACSCharacter::OnHealthChanged(UCSHealthComponent* HealthComponent, float Cu
 	{
 		UnlockTarget();
 
-		ACSCharacter* DamagerCharacter = Cast<ACSCharacter>(DamageCauser->GetOwner());
+		ACSCharacter* DamagerCharacter = DamageEvent.Attacker.Get();
 		if (DamagerCharacter)
 		{
 			DamagerCharacter->OnEnemyDead(this);
@@ -263,8 +464,6 @@ void ACSCharacter::OnHealthChanged(UCSHealthComponent* HealthComponent, float Cu
 
 		ChangeState(CharacterStateType::DEAD);
 	}
-
-	UpdateHealth(HealthComp->GetHealthPercentage());
 }
 
 #pragma region Target Locking
@@ -283,10 +482,10 @@ void ACSCharacter::ToggleLockTarget()
 			TargetLocked = true;
 			//bUseControllerRotationYaw = true;
 			GetCharacterMovement()->bOrientRotationToMovement = false;
-			LockedEnemy->OnSetAsTarget(true);
+			LockedEnemy->SetUITarget(true);
 			if (CurrentState == CharacterStateType::AIM)
 			{
-				SetCrosshairActive(false);
+				SetUICrosshairActive(false);
 			}
 			else
 			{
@@ -302,11 +501,11 @@ void ACSCharacter::ToggleLockTarget()
 
 		if (LockedEnemy != nullptr)
 		{
-			LockedEnemy->OnSetAsTarget(false);
+			LockedEnemy->SetUITarget(false);
 			LockedEnemy = nullptr;
 			if (CurrentState == CharacterStateType::AIM)
 			{
-				SetCrosshairActive(true);
+				SetUICrosshairActive(true);
 			}
 			else
 			{
@@ -333,7 +532,7 @@ bool ACSCharacter::LockTarget()
 			continue;
 
 		FVector VectorToEnemy = FoundCharacters[i]->GetActorLocation() - GetActorLocation();
-		float Dot = FVector::DotProduct(VectorToEnemy.GetSafeNormal(), CameraComp->GetForwardVector().GetSafeNormal());
+		float Dot = FVector::DotProduct(VectorToEnemy.GetSafeNormal(), GetViewForwardVector().GetSafeNormal());
 		float distance = FVector::Distance(GetActorLocation(), FoundCharacters[i]->GetActorLocation());
 
 		if (Dot > MaximumDot /* && distance < ClosestEnemyDistance || distance < EnemyDetectionDistance * 0.75f*/)
@@ -372,7 +571,7 @@ void ACSCharacter::ChangeLockedTarget(float Direction)
 	ACSCharacter* ClosestEnemy = nullptr;
 
 	/*
-	float RotationDifference = VectorToEnemy.ToOrientationRotator().Yaw - CameraComp->GetForwardVector().ToOrientationRotator().Yaw;
+	float RotationDifference = VectorToEnemy.ToOrientationRotator().Yaw - GetViewForwardVector().ToOrientationRotator().Yaw;
 	DrawDebugString(GetWorld(), FoundCharacters[i]->GetActorLocation(), FString::SanitizeFloat(RotationDifference), 0, FColor::Yellow, 2.0f);
 	*/
 
@@ -380,8 +579,8 @@ void ACSCharacter::ChangeLockedTarget(float Direction)
 	float ClosestForwardDot = 1.0f;
 
 	FVector VectorToTargettedEnemy = LockedEnemy->GetActorLocation() - GetActorLocation();
-	float LockedEnemyRightDot = FVector::DotProduct(VectorToTargettedEnemy.GetSafeNormal(), CameraComp->GetRightVector().GetSafeNormal());
-	float LockedEnemyForwardDot = FVector::DotProduct(VectorToTargettedEnemy.GetSafeNormal(), CameraComp->GetForwardVector().GetSafeNormal());
+	float LockedEnemyRightDot = FVector::DotProduct(VectorToTargettedEnemy.GetSafeNormal(), GetViewRightVector().GetSafeNormal());
+	float LockedEnemyForwardDot = FVector::DotProduct(VectorToTargettedEnemy.GetSafeNormal(), GetViewForwardVector().GetSafeNormal());
 
 	for (size_t i = 0; i < FoundCharacters.Num(); i++)
 	{
@@ -389,8 +588,8 @@ void ACSCharacter::ChangeLockedTarget(float Direction)
 			continue;
 
 		FVector VectorToEnemy = FoundCharacters[i]->GetActorLocation() - GetActorLocation();
-		float RightDot = FVector::DotProduct(VectorToEnemy.GetSafeNormal(), CameraComp->GetRightVector().GetSafeNormal());
-		float ForwardDot = FVector::DotProduct(VectorToEnemy.GetSafeNormal(), CameraComp->GetForwardVector().GetSafeNormal());
+		float RightDot = FVector::DotProduct(VectorToEnemy.GetSafeNormal(), GetViewRightVector().GetSafeNormal());
+		float ForwardDot = FVector::DotProduct(VectorToEnemy.GetSafeNormal(), GetViewForwardVector().GetSafeNormal());
 
 		//                Get left enemy                                   //Get Right Enemy                                                           
 		if (Direction < 0.0f && RightDot < LockedEnemyRightDot || Direction > 0.0f && RightDot > LockedEnemyRightDot)
@@ -414,11 +613,11 @@ void ACSCharacter::ChangeLockedTarget(float Direction)
 	{
 		if (LockedEnemy != nullptr)
 		{
-			LockedEnemy->OnSetAsTarget(false);
+			LockedEnemy->SetUITarget(false);
 		}
 
 		LockedEnemy = Cast<ACSCharacter>(ClosestEnemy);
-		LockedEnemy->OnSetAsTarget(true);
+		LockedEnemy->SetUITarget(true);
 
 		CanChangeLockedEnemy = false;
 		FTimerHandle TimerHandle_LockedEnemyChange;
@@ -477,7 +676,7 @@ bool ACSCharacter::IsEnemyVisible(ACSCharacter* Enemy)
 
 	//Check if the actor is in camera view
 	FVector VectorToEnemy = (Enemy->GetActorLocation() - GetActorLocation()).GetSafeNormal();
-	float dot = FVector::DotProduct(VectorToEnemy, CameraComp->GetForwardVector().GetSafeNormal());
+	float dot = FVector::DotProduct(VectorToEnemy, GetViewForwardVector().GetSafeNormal());
 
 	if (dot < 0.2) {
 		return false;
@@ -575,6 +774,9 @@ void ACSCharacter::AddState(TSubclassOf<UCSCharacterState> StateClass)
 	{
 		StateAction->Init(this, RequestTime);
 		States.Add(StateAction->StateType, StateAction);
+
+		if (StateAction->StateType == CharacterStateType::HIT) { HitState = Cast<UCSCharacterState_Hit>(StateAction); }
+		else if (StateAction->StateType == CharacterStateType::BLOCK) { BlockState = Cast<UCSCharacterState_Block>(StateAction); }
 	}
 }
 
@@ -631,6 +833,18 @@ UCSCharacterState* ACSCharacter::GetCharacterState(CharacterStateType StateType)
 }
 
 
+UCSCharacterState_Hit* ACSCharacter::GetHitState() const
+{
+	return HitState;
+}
+
+
+UCSCharacterState_Block* ACSCharacter::GetBlockState() const
+{
+	return BlockState;
+}
+
+
 ACSCharacter* ACSCharacter::GetLockedTarget() const
 {
 	return LockedEnemy;
@@ -669,13 +883,24 @@ uint8 ACSCharacter::GetStateCurrentSubstate(CharacterStateType StateType) const
 
 void ACSCharacter::SetParriable(bool NewParriable)
 {
-	Parriable = NewParriable;
+	UCSParryWindowRegistry* ParryRegistry = GetWorld()->GetSubsystem<UCSParryWindowRegistry>();
+	if (ParryRegistry == nullptr) { return; }
+
+	if (NewParriable)
+	{
+		ParryRegistry->OpenParryWindow(this, MaxParryWindowDuration);
+	}
+	else
+	{
+		ParryRegistry->CloseParryWindow(this);
+	}
 }
 
 
 bool ACSCharacter::IsParriable() const
 {
-	return Parriable;
+	UCSParryWindowRegistry* ParryRegistry = GetWorld()->GetSubsystem<UCSParryWindowRegistry>();
+	return ParryRegistry && ParryRegistry->HasActiveParryWindow(this);
 }
 
 
@@ -708,19 +933,19 @@ void ACSCharacter::ChangeCombatType(CSCombatType NewCombatType)
 	switch (NewCombatType)
 	{
 	case CSCombatType::MELEE:
-		CurrentWeapon->SetActorHiddenInGame(false);
-		CurrentShield->SetActorHiddenInGame(false);
+		if (CurrentWeapon) { CurrentWeapon->SetActorHiddenInGame(false); }
+		if (ShieldMeshComp) { ShieldMeshComp->SetVisibility(true); }
 
-		CurrentRangedWeapon->SetActorHiddenInGame(true);
+		if (CurrentRangedWeapon) { CurrentRangedWeapon->SetActorHiddenInGame(true); }
 
 		break;
 
 	case CSCombatType::RANGED:
 
-		CurrentWeapon->SetActorHiddenInGame(true);
-		CurrentShield->SetActorHiddenInGame(true);
+		if (CurrentWeapon) { CurrentWeapon->SetActorHiddenInGame(true); }
+		if (ShieldMeshComp) { ShieldMeshComp->SetVisibility(false); }
 
-		CurrentRangedWeapon->SetActorHiddenInGame(false);
+		if (SpawnRangedWeapon()) { CurrentRangedWeapon->SetActorHiddenInGame(false); }
 
 		break;
 
@@ -736,20 +961,76 @@ UCSCameraManagerComponent* ACSCharacter::GetCameraManager() const
 }
 
 
+void ACSCharacter::PlayCameraShake(TSubclassOf<UCameraShakeBase> CameraShake, float Scale)
+{
+#if CS_WITH_COSMETICS
+	if (CameraManagerComp) { CameraManagerComp->PlayCameraShake(CameraShake, Scale); }
+#endif
+}
+
+void ACSCharacter::StopCameraShake(TSubclassOf<UCameraShakeBase> CameraShake)
+{
+#if CS_WITH_COSMETICS
+	if (CameraManagerComp) { CameraManagerComp->StopCameraShake(CameraShake); }
+#endif
+}
+
 void ACSCharacter::PlayForceFeedback(UForceFeedbackEffect* ForceFeedback, FForceFeedbackParameters ForceFeedbackParameters)
 {
-	if (ForceFeedback && IsPlayerControlled())
+#if CS_WITH_COSMETICS
+	//Only the player holding the controller feels it, remote players play their own
+	APlayerController* PlayerController = Cast<APlayerController>(GetController());
+	if (ForceFeedback && PlayerController && PlayerController->IsLocalController())
 	{
-		GetWorld()->GetFirstPlayerController()->ClientPlayForceFeedback(ForceFeedback, ForceFeedbackParameters);
+		PlayerController->ClientPlayForceFeedback(ForceFeedback, ForceFeedbackParameters);
 	}
+#endif
 }
 
 void ACSCharacter::StopForceFeedback(UForceFeedbackEffect* ForceFeedback)
 {
-	if (ForceFeedback && IsPlayerControlled())
+#if CS_WITH_COSMETICS
+	APlayerController* PlayerController = Cast<APlayerController>(GetController());
+	if (ForceFeedback && PlayerController && PlayerController->IsLocalController())
+	{
+		PlayerController->ClientStopForceFeedback(ForceFeedback, NAME_None);
+	}
+#endif
+}
+
+float ACSCharacter::GetCosmeticSignificance(const AActor* Other) const
+{
+	if (!CSAreCosmeticsEnabled(GetWorld())) { return 0.0f; }
+	if (CosmeticCulling <= 0) { return 1.0f; }
+
+	//Weapons and projectiles stand for the character using them
+	const APawn* OtherPawn = Cast<APawn>(Other);
+	if (OtherPawn == nullptr && Other) { OtherPawn = Cast<APawn>(Other->GetOwner()); }
+
+	if ((IsPlayerControlled() && IsLocallyControlled()) || (OtherPawn && OtherPawn->IsPlayerControlled() && OtherPawn->IsLocallyControlled())) { return 1.0f; }
+
+	if (!WasRecentlyRendered(0.2f) && (Other == nullptr || !Other->WasRecentlyRendered(0.2f))) { return 0.0f; }
+
+	float ClosestViewDistanceSquared = TNumericLimits<float>::Max();
+	for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
 	{
-		GetWorld()->GetFirstPlayerController()->ClientStopForceFeedback(ForceFeedback, NAME_None);
+		APlayerController* PlayerController = Iterator->Get();
+		if (PlayerController == nullptr || !PlayerController->IsLocalController() || PlayerController->PlayerCameraManager == nullptr) { continue; }
+
+		ClosestViewDistanceSquared = FMath::Min(ClosestViewDistanceSquared, FVector::DistSquared(PlayerController->PlayerCameraManager->GetCameraLocation(), GetActorLocation()));
 	}
+
+	if (ClosestViewDistanceSquared == TNumericLimits<float>::Max() || CosmeticCullDistance <= 0.0f) { return 0.0f; }
+
+	return FMath::Clamp(1.0f - FMath::Sqrt(ClosestViewDistanceSquared) / CosmeticCullDistance, 0.0f, 1.0f);
+}
+
+CSCosmeticDetail ACSCharacter::GetCosmeticDetail(const AActor* Other) const
+{
+	float Significance = GetCosmeticSignificance(Other);
+	if (Significance <= 0.0f) { return CSCosmeticDetail::NONE; }
+
+	return Significance >= CosmeticFullDetailSignificance ? CSCosmeticDetail::FULL : CSCosmeticDetail::REDUCED;
 }
 
 float ACSCharacter::GetMovementSpeed() const
@@ -793,6 +1074,76 @@ void ACSCharacter::OnAnimationNotify(CharacterStateType StateType, FString Anima
 }
 
 
+const TMap<FName, CharacterStateType>& ACSCharacter::GetStateEndNotifies()
+{
+	static const TMap<FName, CharacterStateType> StateEndNotifies =
+	{
+		{ "AttackEnd", CharacterStateType::ATTACK },
+		{ "DodgeEnd", CharacterStateType::DODGE },
+		{ "ParryEnd", CharacterStateType::PARRY },
+		{ "KickEnd", CharacterStateType::KICK },
+		{ "ShootEnd", CharacterStateType::AIM },
+		{ "HitEnd", CharacterStateType::HIT },
+		{ "DeadEnd", CharacterStateType::DEAD },
+	};
+
+	return StateEndNotifies;
+}
+
+
+void ACSCharacter::OnMontageTimelineNotify(FName NotifyName)
+{
+	if (NotifyName == "SetAsParriable") { SetParriable(true); }
+	else if (NotifyName == "SetAsUnparriable") { SetParriable(false); }
+	else if (NotifyName == "SetAsInvulnerable") { HealthComp->SetInvulnerable(true); }
+	else if (NotifyName == "SetAsVulnerable") { HealthComp->SetInvulnerable(false); }
+	else if (const CharacterStateType* EndedState = GetStateEndNotifies().Find(NotifyName))
+	{
+		OnAnimationEnded(*EndedState);
+	}
+	else
+	{
+		OnAnimationNotify(CurrentState, NotifyName.ToString());
+	}
+}
+
+
+float ACSCharacter::PlayAnimMontage(UAnimMontage* AnimMontage, float InPlayRate, FName StartSectionName)
+{
+	float Duration = Super::PlayAnimMontage(AnimMontage, InPlayRate, StartSectionName);
+
+	MontageTimelineComp->OnMontagePlayed(AnimMontage, InPlayRate, StartSectionName);
+
+	return Duration;
+}
+
+
+void ACSCharacter::StopAnimMontage(UAnimMontage* AnimMontage)
+{
+	Super::StopAnimMontage(AnimMontage);
+
+	MontageTimelineComp->OnMontageStopped(AnimMontage);
+}
+
+
+bool ACSCharacter::IsUsingMontageTimings() const
+{
+	return MontageTimelineComp->IsUsingTimings();
+}
+
+
+FTransform ACSCharacter::GetCombatSocketTransform(FName SocketName) const
+{
+	FTransform SocketTransform;
+	if (MontageTimelineComp->GetSocketTransform(SocketName, SocketTransform))
+	{
+		return SocketTransform;
+	}
+
+	return GetMesh()->GetSocketTransform(SocketName);
+}
+
+
 void ACSCharacter::NotifyActionToState(CharacterStateType StateType, FString ActionName, EInputEvent KeyEvent)
 {
 	if (States.Contains(StateType))
@@ -815,20 +1166,32 @@ void ACSCharacter::SpawnEquipment()
 		CurrentWeapon->AttachToComponent(GetMesh(), FAttachmentTransformRules::SnapToTargetNotIncludingScale, WeaponAttachSocketName);
 	}
 
+	MeleeWeaponComp->SetWeapon(Cast<ACSMeleeWeapon>(CurrentWeapon));
+
 	//Shield setup
-	CurrentShield = GetWorld()->SpawnActor<ACSShield>(StarterShieldClass, FVector::ZeroVector, FRotator::ZeroRotator, SpawnParams);
-	if (CurrentShield)
+	const ACSShield* ShieldDefaults = StarterShieldClass ? StarterShieldClass->GetDefaultObject<ACSShield>() : nullptr;
+	if (ShieldDefaults && ShieldMeshComp == nullptr && CSAreCosmeticsEnabled(GetWorld()))
 	{
-		CurrentShield->SetOwner(this);
-		CurrentShield->AttachToComponent(GetMesh(), FAttachmentTransformRules::SnapToTargetNotIncludingScale, ShieldAttachSocketName);
+		ShieldMeshComp = ShieldDefaults->CreateMeshComponent(this, ShieldAttachSocketName);
 	}
+}
+
+ACSRangedWeapon* ACSCharacter::SpawnRangedWeapon()
+{
+	if (CurrentRangedWeapon || StarterRangedWeaponClass == nullptr) { return CurrentRangedWeapon; }
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
 
 	CurrentRangedWeapon = GetWorld()->SpawnActor<ACSRangedWeapon>(StarterRangedWeaponClass, FVector::ZeroVector, FRotator::ZeroRotator, SpawnParams);
 	if (CurrentRangedWeapon)
 	{
 		CurrentRangedWeapon->SetCharacter(this);
 		CurrentRangedWeapon->AttachToComponent(GetMesh(), FAttachmentTransformRules::SnapToTargetNotIncludingScale, RangedWeaponAttachSocketName);
+		CurrentRangedWeapon->SetActorHiddenInGame(true);
 	}
+
+	return CurrentRangedWeapon;
 }
 #pragma endregion
 
@@ -845,7 +1208,10 @@ void ACSCharacter::Tick(float DeltaTime)
 
 	//GEngine->AddOnScreenDebugMessage(INDEX_NONE, DeltaTime, FColor::Blue, TEXT("%s", UENUM::>));
 
-	CameraManagerComp->AdjustCamera(DeltaTime, LockedEnemy, NearbyEnemies.Num());
+	if (CameraManagerComp)
+	{
+		CameraManagerComp->AdjustCamera(DeltaTime, LockedEnemy, NearbyEnemies.Num());
+	}
 
 	if (States.Contains(CurrentState))
 	{
@@ -858,6 +1224,17 @@ void ACSCharacter::Tick(float DeltaTime)
 	}
 }
 
+void ACSCharacter::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+
+	//Players can aim at any moment, have the bow ready instead of spawning it on the first aim
+	if (NewController && NewController->IsPlayerController())
+	{
+		SpawnRangedWeapon();
+	}
+}
+
 
 // Called to bind functionality to input
 void ACSCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
@@ -902,6 +1279,16 @@ void ACSCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCompone
 void ACSCharacter::SetCanMove(bool NewCanMove) { CanMove = NewCanMove; }
 
 
+FVector ACSCharacter::GetViewForwardVector() const
+{
+	return CameraComp ? CameraComp->GetForwardVector() : GetControlRotation().Vector();
+}
+
+FVector ACSCharacter::GetViewRightVector() const
+{
+	return CameraComp ? CameraComp->GetRightVector() : FRotationMatrix(GetControlRotation()).GetScaledAxis(EAxis::Y);
+}
+
 FVector ACSCharacter::GetPawnViewLocation() const
 {
 	if (CameraComp) {
@@ -916,11 +1303,79 @@ UCSHealthComponent* ACSCharacter::GetHealthComponent() const { return HealthComp
 
 UCSStaminaComponent* ACSCharacter::GetStaminaComponent() const { return StaminaComp; }
 
+UCSHitboxComponent* ACSCharacter::GetHitboxComponent() const { return HitboxComp; }
+UCSProjectileNetComponent* ACSCharacter::GetProjectileNetComponent() const { return ProjectileNetComp; }
+
 ACSWeapon* ACSCharacter::GetCurrentWeapon() { return CurrentWeapon; }
 
+UCSMeleeWeaponComponent* ACSCharacter::GetMeleeWeaponComponent() const { return MeleeWeaponComp; }
+
 ACSRangedWeapon* ACSCharacter::GetCurrentRangedWeapon() const { return CurrentRangedWeapon; }
 
 bool ACSCharacter::IsTargetLocked() const { return TargetLocked; }
 
 
 
+
+//UI Model ===========================================================================================
+const FCSCharacterUIModel& ACSCharacter::GetUIModel() const
+{
+	return UIModel;
+}
+
+void ACSCharacter::SetUIHealth(float HealthPercentage)
+{
+	UIModel.HealthPercentage = HealthPercentage;
+	MarkUIModelChanged(CSUIModelField::HEALTH);
+}
+
+void ACSCharacter::SetUIStamina(float StaminaPercentage)
+{
+	UIModel.StaminaPercentage = StaminaPercentage;
+	MarkUIModelChanged(CSUIModelField::STAMINA);
+}
+
+void ACSCharacter::SetUITarget(bool IsTarget)
+{
+	UIModel.IsTarget = IsTarget;
+	MarkUIModelChanged(CSUIModelField::TARGET);
+}
+
+void ACSCharacter::SetUICrosshairActive(bool Active)
+{
+	UIModel.CrosshairActive = Active;
+	MarkUIModelChanged(CSUIModelField::CROSSHAIR);
+}
+
+void ACSCharacter::NotifyUIHit()
+{
+	UIModel.HitCount++;
+	MarkUIModelChanged(CSUIModelField::HIT);
+}
+
+void ACSCharacter::MarkUIModelChanged(CSUIModelField Field)
+{
+	UIModel.MarkChanged(Field);
+
+	if (LegacyUIEvents <= 0) { return; }
+
+	PendingLegacyUIChanges |= Field;
+	if (!TimerHandle_LegacyUIEvents.IsValid())
+	{
+		TimerHandle_LegacyUIEvents = GetWorldTimerManager().SetTimerForNextTick(this, &ACSCharacter::SendLegacyUIEvents);
+	}
+}
+
+void ACSCharacter::SendLegacyUIEvents()
+{
+	TimerHandle_LegacyUIEvents.Invalidate();
+
+	CSUIModelField Changes = PendingLegacyUIChanges;
+	PendingLegacyUIChanges = CSUIModelField::NONE;
+
+	if (EnumHasAnyFlags(Changes, CSUIModelField::HEALTH)) { UpdateHealth(UIModel.HealthPercentage); }
+	if (EnumHasAnyFlags(Changes, CSUIModelField::STAMINA)) { UpdateStamina(UIModel.StaminaPercentage); }
+	if (EnumHasAnyFlags(Changes, CSUIModelField::TARGET)) { OnSetAsTarget(UIModel.IsTarget); }
+	if (EnumHasAnyFlags(Changes, CSUIModelField::CROSSHAIR)) { SetCrosshairActive(UIModel.CrosshairActive); }
+	if (EnumHasAnyFlags(Changes, CSUIModelField::HIT)) { OnHit(); }
+}
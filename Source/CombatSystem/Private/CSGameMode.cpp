@@ -2,13 +2,35 @@
 #include "CSGameMode.h"
 #include "Runtime/Engine/Classes/Kismet/GameplayStatics.h"
 #include "GameFramework/PlayerController.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "AssetRegistry/AssetRegistryModule.h"
 #include "CSCharacter.h"
 #include "Components/CSHealthComponent.h"
+#include "Subsystems/CSEnemyPoolSubsystem.h"
+#include "Subsystems/CSProjectilePoolSubsystem.h"
+#include "Subsystems/CSStuckArrowSubsystem.h"
+#include "GameFramework/WorldSettings.h"
+#include "UI/CSHUD.h"
+
+static int32 SoftReset = 1;
+FAutoConsoleVariableRef CVARSoftReset(
+	TEXT("CS.SoftReset"),
+	SoftReset,
+	TEXT("Reset the arena in place after game over instead of reopening the level"),
+	ECVF_Cheat);
 
 ACSGameMode::ACSGameMode() : AGameModeBase()
 {
 	TimeBetweenWaves = 2.0f;
 	TimeToResetGame = 5.0f;
+
+	EnemyClass = TSoftClassPtr<ACSCharacter>(FSoftObjectPath(TEXT("/Game/Blueprints/AI/BP_Enemy_AI.BP_Enemy_AI_C")));
+
+	WavePreloadStartTime = 0.0;
+	StartWaveWhenLoaded = false;
+
+	HUDClass = ACSHUD::StaticClass();
 	//PrimaryActorTick.bCanEverTick = true;
 	//PrimaryActorTick.TickInterval = 1.0f;
 }
@@ -65,6 +87,25 @@ void ACSGameMode::AddEnemy(ACSCharacter* Enemy)
 	AliveEnemies.Add(Enemy);
 }
 
+ACSCharacter* ACSGameMode::SpawnPooledEnemy(TSubclassOf<ACSCharacter> SpawnClass, const FTransform& SpawnTransform)
+{
+	if (SpawnClass == nullptr) { SpawnClass = EnemyClass.Get(); }
+
+	if (SpawnClass == nullptr && !EnemyClass.IsNull())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Enemy class %s spawned before it was preloaded, loading it now"), *EnemyClass.ToString());
+		SpawnClass = EnemyClass.LoadSynchronous();
+	}
+
+	UCSEnemyPoolSubsystem* EnemyPool = GetWorld()->GetSubsystem<UCSEnemyPoolSubsystem>();
+	if (EnemyPool == nullptr || SpawnClass == nullptr) { return nullptr; }
+
+	ACSCharacter* Enemy = EnemyPool->AcquireEnemy(SpawnClass, SpawnTransform);
+	AddEnemy(Enemy);
+
+	return Enemy;
+}
+
 int32 ACSGameMode::GetAliveEnemies()
 {
 	return AliveEnemies.Num();
@@ -91,10 +132,7 @@ void ACSGameMode::StartWave()
 {
 	WaveCount++;
 
-	double DoubleNumberOfEnemiesToSpawn;
-	std::modf((double)((float)WaveCount / 3.0f), &DoubleNumberOfEnemiesToSpawn);
-
-	NumberOfEnemiesToSpawn = FMath::Clamp(DoubleNumberOfEnemiesToSpawn, 1, 100);
+	NumberOfEnemiesToSpawn = GetEnemiesToSpawn(WaveCount);
 
 	GetWorldTimerManager().SetTimer(TimerHandle_EnemySpawner, this, &ACSGameMode::SpawnEnemyTimerElapsed, 1.0f, true, 0.0f);
 
@@ -103,6 +141,32 @@ void ACSGameMode::StartWave()
 	OnWaveStarted();
 }
 
+int32 ACSGameMode::GetEnemiesToSpawn(int32 Wave) const
+{
+	double DoubleNumberOfEnemiesToSpawn;
+	std::modf((double)((float)Wave / 3.0f), &DoubleNumberOfEnemiesToSpawn);
+
+	return FMath::Clamp(DoubleNumberOfEnemiesToSpawn, 1, 100);
+}
+
+void ACSGameMode::GetWaveEnemyArchetypes(int32 Wave, TArray<FCSWaveEnemyArchetype>& OutArchetypes) const
+{
+	if (!EnemyClass.IsNull())
+	{
+		FCSWaveEnemyArchetype& DefaultArchetype = OutArchetypes.AddDefaulted_GetRef();
+		DefaultArchetype.EnemyClass = EnemyClass;
+		DefaultArchetype.PrewarmCount = GetEnemiesToSpawn(Wave);
+	}
+
+	for (const FCSWaveEnemyArchetype& Archetype : EnemyArchetypes)
+	{
+		if (Archetype.EnemyClass.IsNull() || Wave < Archetype.FirstWave) { continue; }
+		if (Archetype.LastWave > 0 && Wave > Archetype.LastWave) { continue; }
+
+		OutArchetypes.Add(Archetype);
+	}
+}
+
 void ACSGameMode::EndWave()
 {
 	GetWorldTimerManager().ClearTimer(TimerHandle_EnemySpawner);
@@ -113,16 +177,152 @@ void ACSGameMode::EndWave()
 
 void ACSGameMode::PrepareForNextWave()
 {
-	GetWorldTimerManager().SetTimer(TimerHandle_NextWaveStart, this, &ACSGameMode::StartWave, TimeBetweenWaves, false);
+	GetWorldTimerManager().SetTimer(TimerHandle_NextWaveStart, this, &ACSGameMode::OnTimeBetweenWavesElapsed, TimeBetweenWaves, false);
 
 	SetWaveState(EWaveState::WaitingToStart);
+
+	PreloadWaveAssets(WaveCount + 1);
+}
+
+void ACSGameMode::OnTimeBetweenWavesElapsed()
+{
+	//Only waits when the break was too short for the assets, they are never loaded in the middle of the fight
+	if (WavePreloadHandle.IsValid() && WavePreloadHandle->IsLoadingInProgress())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Wave %d waiting for its assets"), WaveCount + 1);
+		StartWaveWhenLoaded = true;
+		return;
+	}
+
+	StartWave();
+}
+
+void ACSGameMode::BuildWavePreloadManifest(int32 Wave, TArray<FSoftObjectPath>& OutManifest) const
+{
+	TArray<FCSWaveEnemyArchetype> Archetypes;
+	GetWaveEnemyArchetypes(Wave, Archetypes);
+
+	//Each enemy class brings what it hard references along, such as its states, montages and equipment, the rest is requested with it
+	for (const FCSWaveEnemyArchetype& Archetype : Archetypes)
+	{
+		FSoftObjectPath EnemyClassPath = Archetype.EnemyClass.ToSoftObjectPath();
+		OutManifest.AddUnique(EnemyClassPath);
+
+		for (const FSoftObjectPath& SoftReference : GetEnemySoftReferences(EnemyClassPath))
+		{
+			OutManifest.AddUnique(SoftReference);
+		}
+	}
+
+	for (const TSoftObjectPtr<UObject>& Asset : WavePreloadAssets)
+	{
+		if (!Asset.IsNull()) { OutManifest.AddUnique(Asset.ToSoftObjectPath()); }
+	}
+}
+
+const TArray<FSoftObjectPath>& ACSGameMode::GetEnemySoftReferences(const FSoftObjectPath& EnemyClassPath) const
+{
+	if (const TArray<FSoftObjectPath>* CachedReferences = EnemySoftReferences.Find(EnemyClassPath)) { return *CachedReferences; }
+
+	TArray<FSoftObjectPath>& SoftReferences = EnemySoftReferences.Add(EnemyClassPath);
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+
+	//Walks the packages loaded along with the class, collecting the game assets any of them references softly.
+	//Cooked builds without package dependencies in their asset registry only preload the classes
+	TSet<FName> VisitedPackages;
+	TArray<FName> PackagesToVisit;
+	PackagesToVisit.Add(EnemyClassPath.GetLongPackageFName());
+
+	TArray<FName> Dependencies;
+	TArray<FAssetData> DependencyAssets;
+	while (PackagesToVisit.Num() > 0)
+	{
+		FName PackageName = PackagesToVisit.Pop(false);
+
+		bool AlreadyVisited = false;
+		VisitedPackages.Add(PackageName, &AlreadyVisited);
+		if (AlreadyVisited) { continue; }
+
+		Dependencies.Reset();
+		AssetRegistry.GetDependencies(PackageName, Dependencies, UE::AssetRegistry::EDependencyCategory::Package, UE::AssetRegistry::EDependencyQuery::Hard);
+		for (FName Dependency : Dependencies)
+		{
+			if (Dependency.ToString().StartsWith(TEXT("/Game/"))) { PackagesToVisit.Add(Dependency); }
+		}
+
+		Dependencies.Reset();
+		AssetRegistry.GetDependencies(PackageName, Dependencies, UE::AssetRegistry::EDependencyCategory::Package, UE::AssetRegistry::EDependencyQuery::Soft);
+		for (FName Dependency : Dependencies)
+		{
+			if (!Dependency.ToString().StartsWith(TEXT("/Game/"))) { continue; }
+
+			DependencyAssets.Reset();
+			AssetRegistry.GetAssetsByPackageName(Dependency, DependencyAssets);
+			for (const FAssetData& DependencyAsset : DependencyAssets)
+			{
+				SoftReferences.AddUnique(DependencyAsset.GetSoftObjectPath());
+			}
+		}
+	}
+
+	return SoftReferences;
+}
+
+void ACSGameMode::PreloadWaveAssets(int32 Wave)
+{
+	TArray<FSoftObjectPath> Manifest;
+	BuildWavePreloadManifest(Wave, Manifest);
+
+	StartWaveWhenLoaded = false;
+	WavePreloadStartTime = FPlatformTime::Seconds();
+
+	if (Manifest.Num() == 0)
+	{
+		WavePreloadHandle.Reset();
+		OnWaveAssetsLoaded();
+		return;
+	}
+
+	//Assets already resident complete right away, the previous handle is only released after the new one holds them
+	WavePreloadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(Manifest, FStreamableDelegate::CreateUObject(this, &ACSGameMode::OnWaveAssetsLoaded), FStreamableManager::AsyncLoadHighPriority);
+
+	//None of the paths could be loaded, the wave goes on with whatever is resident
+	if (!WavePreloadHandle.IsValid()) { OnWaveAssetsLoaded(); }
+}
+
+void ACSGameMode::OnWaveAssetsLoaded()
+{
+	UE_LOG(LogTemp, Log, TEXT("Wave %d assets loaded in %.1f ms"), WaveCount + 1, (FPlatformTime::Seconds() - WavePreloadStartTime) * 1000.0);
+
+	//Spawn the enemies of the next wave during the break instead of when they enter
+	UCSEnemyPoolSubsystem* EnemyPool = GetWorld()->GetSubsystem<UCSEnemyPoolSubsystem>();
+	if (EnemyPool)
+	{
+		TArray<FCSWaveEnemyArchetype> Archetypes;
+		GetWaveEnemyArchetypes(WaveCount + 1, Archetypes);
+
+		for (const FCSWaveEnemyArchetype& Archetype : Archetypes)
+		{
+			EnemyPool->PrewarmPool(Archetype.EnemyClass.Get(), Archetype.PrewarmCount);
+		}
+	}
+
+	if (StartWaveWhenLoaded)
+	{
+		StartWaveWhenLoaded = false;
+		StartWave();
+	}
 }
 
 void ACSGameMode::DestroyAllEnemies()
 {
+	UCSEnemyPoolSubsystem* EnemyPool = GetWorld()->GetSubsystem<UCSEnemyPoolSubsystem>();
+
 	for (size_t i = 0; i < Enemies.Num(); i++)
 	{
-		Enemies[i]->StartDestroy();
+		if (EnemyPool) { EnemyPool->ReleaseEnemy(Enemies[i]); }
+		else { Enemies[i]->StartDestroy(); }
 	}
 
 	AliveEnemies.Empty();
@@ -131,9 +331,61 @@ void ACSGameMode::DestroyAllEnemies()
 
 void ACSGameMode::ResetGame()
 {
+	if (SoftReset > 0)
+	{
+		SoftResetGame();
+		return;
+	}
+
 	UGameplayStatics::OpenLevel(this, FName(*GetWorld()->GetName()), false);
 }
 
+void ACSGameMode::SoftResetGame()
+{
+	double StartTime = FPlatformTime::Seconds();
+
+	GetWorldTimerManager().ClearTimer(TimerHandle_EnemySpawner);
+	GetWorldTimerManager().ClearTimer(TimerHandle_NextWaveStart);
+	StartWaveWhenLoaded = false;
+
+	//Everything goes back to its pool instead of being destroyed
+	DestroyAllEnemies();
+
+	UCSProjectilePoolSubsystem* ProjectilePool = GetWorld()->GetSubsystem<UCSProjectilePoolSubsystem>();
+	if (ProjectilePool) { ProjectilePool->ReleaseAllProjectiles(); }
+
+	UCSStuckArrowSubsystem* StuckArrows = GetWorld()->GetSubsystem<UCSStuckArrowSubsystem>();
+	if (StuckArrows) { StuckArrows->ClearStuckArrows(); }
+
+	//A slow motion cut short by the game over would otherwise stay
+	GetWorldSettings()->SetTimeDilation(1.0f);
+
+	for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		APlayerController* PlayerController = Iterator->Get();
+		ACSCharacter* Player = PlayerController ? Cast<ACSCharacter>(PlayerController->GetPawn()) : nullptr;
+		if (Player == nullptr) { continue; }
+
+		AActor* StartSpot = FindPlayerStart(PlayerController);
+		FTransform StartTransform = StartSpot ? FTransform(StartSpot->GetActorRotation(), StartSpot->GetActorLocation()) : Player->GetActorTransform();
+
+		Player->ResetCharacter(StartTransform);
+		PlayerController->SetControlRotation(StartTransform.Rotator());
+	}
+
+	WaveCount = 0;
+	NumberOfEnemiesToSpawn = 0;
+
+	OnGameReset();
+
+	//No break before the first wave, its assets are still resident from the last game
+	SetWaveState(EWaveState::WaitingToStart);
+	PreloadWaveAssets(WaveCount + 1);
+	OnTimeBetweenWavesElapsed();
+
+	UE_LOG(LogTemp, Log, TEXT("Game reset in %.1f ms"), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
 void ACSGameMode::GameOver()
 {
 	EndWave();
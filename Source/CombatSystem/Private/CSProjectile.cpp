@@ -8,6 +8,15 @@
 #include "GameFramework/Character.h"
 #include "DrawDebugHelpers.h"
 #include "../CombatSystem.h"
+#include "CSCharacter.h"
+#include "Components/CSHitboxComponent.h"
+#include "Components/CSHealthComponent.h"
+#include "Subsystems/CSHitResolutionSubsystem.h"
+#include "Subsystems/CSProjectilePoolSubsystem.h"
+#include "Subsystems/CSProjectileSimulationSubsystem.h"
+#include "Subsystems/CSStuckArrowSubsystem.h"
+#include "Components/CSProjectileNetComponent.h"
+#include "Components/CapsuleComponent.h"
 
 #include "Kismet/GameplayStatics.h"
 
@@ -18,7 +27,7 @@
 ACSProjectile::ACSProjectile()
 {
 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bCanEverTick = false;
 
 	CollisionComp = CreateDefaultSubobject<UBoxComponent>(TEXT("CollisionComp"));
 	CollisionComp->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
@@ -32,6 +41,16 @@ ACSProjectile::ACSProjectile()
 	DamageMultiplier = 1.0f;
 
 	CanBeDestroyed = false;
+
+	InUse = true;
+	SimulatesPhysicsByDefault = false;
+	SimulatedFlight = false;
+	Settled = false;
+
+	PenetrationDepth = 5.0f;
+
+	NetId = 0;
+	Cosmetic = false;
 }
 
 // Called when the game starts or when spawned
@@ -39,19 +58,47 @@ void ACSProjectile::BeginPlay()
 {
 	Super::BeginPlay();
 
-	FTimerHandle TimerHandle_CanBeDestroyed;
+	SimulatesPhysicsByDefault = CollisionComp->IsSimulatingPhysics();
+
 	GetWorldTimerManager().SetTimer(TimerHandle_CanBeDestroyed, this, &ACSProjectile::SetCanBeDestroyed, 0.001f, false);
 
-	TrailComponent = UNiagaraFunctionLibrary::SpawnSystemAttached(TrailEffect, MeshComp, FName("TrailSocket"), GetActorLocation(), GetActorRotation(), EAttachLocation::SnapToTarget, true);
-	if (TrailComponent)
+#if CS_WITH_COSMETICS
+	//Kept alive so pooled projectiles can restart it
+	if (CSAreCosmeticsEnabled(GetWorld()))
 	{
-		TrailComponent->AttachToComponent(MeshComp, FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+		TrailComponent = UNiagaraFunctionLibrary::SpawnSystemAttached(TrailEffect, MeshComp, FName("TrailSocket"), GetActorLocation(), GetActorRotation(), EAttachLocation::SnapToTarget, false);
+		if (TrailComponent)
+		{
+			TrailComponent->AttachToComponent(MeshComp, FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+		}
 	}
+#endif
 }
 
 void ACSProjectile::OnOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
 	int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
+	if (bFromSweep)
+	{
+		OnImpact(SweepResult);
+		return;
+	}
+
+	//Physics arrows overlap without a sweep, the material comes from the body that was touched instead of a new trace
+	FHitResult Hit(OtherActor, OtherComp, CollisionComp->GetComponentLocation(), -CollisionComp->GetForwardVector());
+	FBodyInstance* OtherBody = OtherComp ? OtherComp->GetBodyInstance() : nullptr;
+	Hit.PhysMaterial = OtherBody ? OtherBody->GetSimplePhysicalMaterial() : nullptr;
+
+	OnImpact(Hit);
+}
+
+void ACSProjectile::OnImpact(const FHitResult& Hit)
+{
+	if (!InUse) { return; }
+
+	AActor* OtherActor = Hit.GetActor();
+	UPrimitiveComponent* OtherComp = Hit.GetComponent();
+
 	if (!CanBeDestroyed)
 	{
 		//return;
@@ -59,96 +106,305 @@ void ACSProjectile::OnOverlap(UPrimitiveComponent* OverlappedComponent, AActor*
 
 	//DrawDebugSphere(GetWorld(), SpawnPosition, 10.0f, 12, FColor::Green, false, 2.0f);
 
-	//Finish drawing the projectile into the actor to avoid cases such as arrows staying right in the impact point
-	SetActorLocation(GetActorLocation() + GetActorForwardVector().GetSafeNormal() * 5.0f);
+	if (OtherActor == nullptr || GetOwner() == nullptr || OtherActor == GetOwner() || OtherActor->GetOwner() == GetOwner())
+	{
+		//Physics arrows brushing their shooter keep flying, arrows the simulation already stopped have nowhere to go
+		if (!CollisionComp->IsSimulatingPhysics()) { ReturnToPool(); }
+		return;
+	}
+
+	//Surface, impact point and normal all come from the hit that stopped the arrow
+	EPhysicalSurface PhysicalSurface = UPhysicalMaterial::DetermineSurfaceType(Hit.PhysMaterial.Get());
+	FVector ImpactPoint = Hit.ImpactPoint;
 
-	if (OtherActor && GetOwner() && OtherActor != GetOwner() && OtherActor->GetOwner() != GetOwner())
+	//Characters are resolved against their hitboxes
+	ACSCharacter* HitCharacter = Cast<ACSCharacter>(OtherActor);
+	if (HitCharacter && HitCharacter->GetHitboxComponent())
 	{
-		UGameplayStatics::ApplyDamage(OtherActor, BaseDamage * DamageMultiplier, GetOwner()->GetInstigatorController(), this, DamageType);
-		EPhysicalSurface PhysicalSurface = DetectCollidedPhysicalSurface();
+		PhysicalSurface = SURFACE_FLESH;
+
+		//The arrow touches the capsule before the body so test its path through the whole capsule
+		FVector Forward = CollisionComp->GetForwardVector().GetSafeNormal();
+		float PenetrationDistance = HitCharacter->GetCapsuleComponent()->GetScaledCapsuleRadius() * 2.0f;
+		FCSHitboxHit HitboxHit;
+		if (HitCharacter->GetHitboxComponent()->IntersectSegment(GetActorLocation() - Forward * 20.0f, GetActorLocation() + Forward * PenetrationDistance, 0.0f, HitboxHit))
+		{
+			PhysicalSurface = HitboxHit.SurfaceType;
+			ImpactPoint = HitboxHit.ImpactPoint;
+			DamageMultiplier *= HitboxHit.DamageMultiplier;
+		}
+	}
+
+	FString DebugString = "OtherActor: " + OtherActor->GetFName().ToString() + "\n OtherComponent: " + GetNameSafe(OtherComp)
+		+ "\n SurfaceType : " + FString::FromInt(PhysicalSurface);
+
+	//DrawDebugString(GetWorld(), OtherActor->GetActorLocation() + FVector(0.0f, 0.0f, 0.0f), DebugString, NULL, FColor::Yellow, 3.0f, true, 1.0f);
+
+	//DrawDebugSphere(GetWorld(), GetActorLocation(), 20.0f, 12, FColor::Red, false, 2.0f);
 
-		FString DebugString = "OtherActor: " + OtherActor->GetFName().ToString() + "\n OtherComponent: " + OtherComp->GetFName().ToString()
-			+ "\n SurfaceType : " + FString::FromInt(PhysicalSurface);
+	ACharacter* OtherCharacter = HitCharacter;
 
-		//DrawDebugString(GetWorld(), OtherActor->GetActorLocation() + FVector(0.0f, 0.0f, 0.0f), DebugString, NULL, FColor::Yellow, 3.0f, true, 1.0f);
+	//Check if it is an object possessed by a character such a shield or sword
+	if (!OtherCharacter && OtherActor->GetOwner()) { OtherCharacter = Cast<ACharacter>(OtherActor->GetOwner()); }
+
+	if (OtherCharacter && PhysicalSurface == 0) { PhysicalSurface = SURFACE_FLESH; }
+
+	//Cosmetic arrows only stop, the server resolves the hit and sends back its effects
+	if (Cosmetic)
+	{
+		Settle(OtherCharacter == nullptr, OtherComp);
+		return;
+	}
 
-		//DrawDebugSphere(GetWorld(), GetActorLocation(), 20.0f, 12, FColor::Red, false, 2.0f);
+	FCSHitRecord HitRecord;
+	HitRecord.Victim = OtherActor;
+	HitRecord.DamageEvent.Attacker = Cast<ACSCharacter>(GetOwner());
+	HitRecord.DamageEvent.DamageCauser = this;
+	HitRecord.DamageEvent.BaseDamage = BaseDamage;
+	HitRecord.DamageEvent.DamageMultiplier = DamageMultiplier;
+	HitRecord.DamageEvent.SurfaceType = PhysicalSurface;
+	HitRecord.DamageEvent.bHasImpactPoint = true;
+	HitRecord.DamageEvent.ImpactPoint = ImpactPoint;
+	HitRecord.DamageEvent.ImpactNormal = Hit.ImpactNormal;
+	HitRecord.DamageEvent.DamageType = DamageType;
+	HitRecord.bDealsDamage = true;
+
+#if CS_WITH_COSMETICS
+	if (CSAreCosmeticsEnabled(GetWorld()))
+	{
+		UNiagaraSystem* ImpactEffect = nullptr;
+		USoundBase* ImpactSound = nullptr;
+		GetImpactEffects(PhysicalSurface, ImpactEffect, ImpactSound);
+		HitRecord.ImpactEffect = ImpactEffect;
+		HitRecord.ImpactSound = ImpactSound;
+	}
+#endif
 
-		ACharacter* OtherCharacter = Cast<ACharacter>(OtherActor);
+	UCSHitResolutionSubsystem* HitResolution = GetWorld()->GetSubsystem<UCSHitResolutionSubsystem>();
+	if (HitResolution)
+	{
+		HitResolution->AddHit(MoveTemp(HitRecord));
+	}
 
-		//Check if it is an object possessed by a character such a shield or sword
-		if (!OtherCharacter && OtherActor->GetOwner()) { OtherCharacter = Cast<ACharacter>(OtherActor->GetOwner()); }
+	//Clients only get where the authoritative arrow ended
+	ACSCharacter* OwnerCharacter = Cast<ACSCharacter>(GetOwner());
+	UCSProjectileNetComponent* ProjectileNetComp = OwnerCharacter ? OwnerCharacter->GetProjectileNetComponent() : nullptr;
+	if (NetId != 0 && ProjectileNetComp)
+	{
+		FCSProjectileHitParams HitParams;
+		HitParams.ProjectileId = NetId;
+		HitParams.ImpactPoint = ImpactPoint;
+		HitParams.ImpactNormal = Hit.ImpactNormal;
+		HitParams.SurfaceType = PhysicalSurface;
+		HitParams.Stuck = OtherCharacter == nullptr && (OtherComp == nullptr || OtherComp->Mobility != EComponentMobility::Movable);
+		ProjectileNetComp->OnAuthoritativeImpact(HitParams);
+	}
 
-		if (OtherCharacter && PhysicalSurface == 0) { PhysicalSurface = SURFACE_FLESH; }
+	Settle(OtherCharacter == nullptr, OtherComp);
+}
 
-		if (PhysicalSurface == SURFACE_FLESH_CRITICAL) { DamageMultiplier = 5.0f; }
+void ACSProjectile::Settle(bool Stick, UPrimitiveComponent* OtherComp)
+{
+	CollisionComp->SetSimulatePhysics(false);
+	DisableComponentsSimulatePhysics();
 
-		PlayImpactEffects(PhysicalSurface, OverlappedComponent->GetComponentLocation());
+	Settled = true;
 
-		if (OtherCharacter)
+	if (!Stick)
+	{
+		//AttachToComponent(OtherCharacter->GetMesh(), FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+		ReturnToPool();
+	}
+	//Arrows stuck in geometry that never moves become instances so the actor can be reused right away
+	else if (OtherComp == nullptr || OtherComp->Mobility != EComponentMobility::Movable)
+	{
+		UCSStuckArrowSubsystem* StuckArrows = GetWorld()->GetSubsystem<UCSStuckArrowSubsystem>();
+		if (StuckArrows && StuckArrows->AddStuckArrow(MeshComp))
 		{
-			//AttachToComponent(OtherCharacter->GetMesh(), FAttachmentTransformRules::SnapToTargetNotIncludingScale);
-			Destroy();
+			ReturnToPool();
 		}
+	}
+}
 
-		CollisionComp->SetSimulatePhysics(false);
-		DisableComponentsSimulatePhysics();
+void ACSProjectile::ApplyAuthoritativeImpact(const FVector& ImpactPoint, const FVector& ImpactNormal, bool Stuck)
+{
+	if (!InUse) { return; }
+
+	if (SimulatedFlight)
+	{
+		UCSProjectileSimulationSubsystem* ProjectileSimulation = GetWorld()->GetSubsystem<UCSProjectileSimulationSubsystem>();
+		if (ProjectileSimulation) { ProjectileSimulation->RemoveProjectile(this); }
 	}
 
+	//Keeps its own direction, the normal only tells which side of the surface it came from
+	FVector Direction = GetActorForwardVector();
+	if (FVector::DotProduct(Direction, ImpactNormal) > 0.0f) { Direction = -ImpactNormal; }
+
+	EndSimulatedFlight(ImpactPoint, Direction);
+	Settle(Stuck, nullptr);
+}
+
+void ACSProjectile::SetNetId(uint16 NewNetId, bool IsCosmetic)
+{
+	NetId = NewNetId;
+	Cosmetic = IsCosmetic;
+}
+
+void ACSProjectile::SetCosmetic(bool IsCosmetic)
+{
+	Cosmetic = IsCosmetic;
 }
 
-void ACSProjectile::PlayImpactEffects(EPhysicalSurface SurfaceType, FVector ImpactPoint)
+uint16 ACSProjectile::GetNetId() const
 {
-	UNiagaraSystem* ImpactEffect;
-	USoundBase* SoundEffect;
+	return NetId;
+}
+
+void ACSProjectile::GetImpactEffects(EPhysicalSurface SurfaceType, UNiagaraSystem*& OutImpactEffect, USoundBase*& OutImpactSound) const
+{
+	if (ImpactEffectTable.Find(SurfaceType, 0u, OutImpactEffect, OutImpactSound)) { return; }
 
 	switch (SurfaceType)
 	{
 	case SURFACE_FLESH:
-		ImpactEffect = FleshImpactEffect;
-		SoundEffect = FleshImpactSound;
+		OutImpactEffect = FleshImpactEffect;
+		OutImpactSound = FleshImpactSound;
 		break;
 	case SURFACE_FLESH_CRITICAL:
-		ImpactEffect = FleshImpactEffect;
-		SoundEffect = FleshImpactSound;
+		OutImpactEffect = FleshImpactEffect;
+		OutImpactSound = FleshImpactSound;
 		break;
 
 	default:
-		ImpactEffect = DefaultImpactEffect;
-		SoundEffect = DefaultImpactSound;
+		OutImpactEffect = DefaultImpactEffect;
+		OutImpactSound = DefaultImpactSound;
 		break;
 	}
+}
 
-	if (ImpactEffect) {
-		UNiagaraFunctionLibrary::SpawnSystemAtLocation(GetWorld(), ImpactEffect, ImpactPoint);
+void ACSProjectile::ActivateProjectile(const FTransform& SpawnTransform, AActor* NewOwner)
+{
+	InUse = true;
+	Settled = false;
+
+	SetOwner(NewOwner);
+	DamageMultiplier = 1.0f;
+
+	//Move it while collision is still disabled so it doesn't overlap anything on the way
+	SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+
+	CollisionComp->SetSimulatePhysics(SimulatesPhysicsByDefault);
+	if (SimulatesPhysicsByDefault)
+	{
+		CollisionComp->SetPhysicsLinearVelocity(FVector::ZeroVector);
+		CollisionComp->SetPhysicsAngularVelocityInDegrees(FVector::ZeroVector);
 	}
 
-	if (SoundEffect) {
-		UGameplayStatics::PlaySoundAtLocation(GetWorld(), SoundEffect, ImpactPoint);
+	CanBeDestroyed = false;
+	GetWorldTimerManager().SetTimer(TimerHandle_CanBeDestroyed, this, &ACSProjectile::SetCanBeDestroyed, 0.001f, false);
+
+	//Arrows of shooters nobody sees fly without their trail
+	ACSCharacter* OwnerCharacter = Cast<ACSCharacter>(NewOwner);
+	if (TrailComponent && (OwnerCharacter == nullptr || OwnerCharacter->GetCosmeticDetail() != CSCosmeticDetail::NONE))
+	{
+		TrailComponent->Activate(true);
 	}
 }
 
-void ACSProjectile::SetCanBeDestroyed()
+void ACSProjectile::DeactivateProjectile()
 {
-	CanBeDestroyed = true;
+	InUse = false;
+	Settled = false;
+
+	NetId = 0;
+	Cosmetic = false;
+
+	if (SimulatedFlight)
+	{
+		SimulatedFlight = false;
+
+		UCSProjectileSimulationSubsystem* ProjectileSimulation = GetWorld()->GetSubsystem<UCSProjectileSimulationSubsystem>();
+		if (ProjectileSimulation) { ProjectileSimulation->RemoveProjectile(this); }
+	}
+
+	GetWorldTimerManager().ClearTimer(TimerHandle_CanBeDestroyed);
+
+	CollisionComp->SetSimulatePhysics(false);
+	SetActorEnableCollision(false);
+	SetActorHiddenInGame(true);
+
+	if (TrailComponent)
+	{
+		TrailComponent->DeactivateImmediate();
+	}
 }
 
-EPhysicalSurface ACSProjectile::DetectCollidedPhysicalSurface()
+void ACSProjectile::ReturnToPool()
 {
-	FVector Offset = CollisionComp->GetForwardVector().GetSafeNormal() * 20.0f;
-	FVector TraceStart = GetActorLocation() - Offset;
-	FVector TraceEnd = CollisionComp->GetComponentLocation() - Offset + CollisionComp->GetForwardVector().GetSafeNormal() * 40.0f;
+	UCSProjectilePoolSubsystem* ProjectilePool = GetWorld()->GetSubsystem<UCSProjectilePoolSubsystem>();
+	if (ProjectilePool)
+	{
+		ProjectilePool->ReleaseProjectile(this);
+	}
+	else
+	{
+		Destroy();
+	}
+}
 
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this);
-	QueryParams.bTraceComplex = true;
-	QueryParams.bReturnPhysicalMaterial = true;
+bool ACSProjectile::IsInUse() const
+{
+	return InUse;
+}
+
+bool ACSProjectile::IsSettled() const
+{
+	return Settled;
+}
+
+void ACSProjectile::Launch(const FVector& Impulse, bool UseSimulation)
+{
+	UCSProjectileSimulationSubsystem* ProjectileSimulation = UseSimulation ? GetWorld()->GetSubsystem<UCSProjectileSimulationSubsystem>() : nullptr;
+	if (ProjectileSimulation && CollisionComp->IsSimulatingPhysics())
+	{
+		ProjectileSimulation->AddProjectile(this, Impulse / CollisionComp->GetMass());
+	}
+	else if (CollisionComp->IsSimulatingPhysics())
+	{
+		CollisionComp->AddImpulse(Impulse);
+	}
+}
+
+void ACSProjectile::BeginSimulatedFlight()
+{
+	SimulatedFlight = true;
+
+	//Only moved for rendering, the simulation traces for it
+	CollisionComp->SetSimulatePhysics(false);
+	SetActorEnableCollision(false);
+}
+
+void ACSProjectile::EndSimulatedFlight(const FVector& Location, const FVector& Velocity)
+{
+	SimulatedFlight = false;
 
-	FHitResult Hit;
-	GetWorld()->LineTraceSingleByChannel(Hit, TraceStart, TraceEnd, COLLISION_WEAPON, QueryParams);
-	//DrawDebugLine(GetWorld(), TraceStart, TraceEnd, FColor::Green, false, 10.0f, 0u, 2.0f);
+	//Placed once at the impact, sunk along its direction so it doesn't look like it stopped right on the surface
+	if (!Velocity.IsNearlyZero())
+	{
+		SetActorLocationAndRotation(Location + Velocity.GetSafeNormal() * PenetrationDepth, Velocity.Rotation(), false, nullptr, ETeleportType::TeleportPhysics);
+	}
+	else
+	{
+		SetActorLocation(Location, false, nullptr, ETeleportType::TeleportPhysics);
+	}
+}
 
-	return UPhysicalMaterial::DetermineSurfaceType(Hit.PhysMaterial.Get());
+void ACSProjectile::SetCanBeDestroyed()
+{
+	CanBeDestroyed = true;
 }
 
 // Called every frame
@@ -167,6 +423,11 @@ void ACSProjectile::SetDamageMultiplier(float NewDamageMultiplier)
 	DamageMultiplier = NewDamageMultiplier;
 }
 
+float ACSProjectile::GetDamageMultiplier() const
+{
+	return DamageMultiplier;
+}
+
 UBoxComponent* ACSProjectile::GetCollisionComponent() const
 {
 	return CollisionComp;
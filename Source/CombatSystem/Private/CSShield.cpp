@@ -1,14 +1,15 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "CSShield.h"
-#include "CSWeapon.h"
-#include "Components/BoxComponent.h"
+#include "CSCharacter.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
 
 // Sets default values
 ACSShield::ACSShield()
 {
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bCanEverTick = false;
 
 	MeshComp = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("MeshComp"));
 	MeshComp->SetCollisionEnabled(ECollisionEnabled::NoCollision);
@@ -21,9 +22,37 @@ void ACSShield::BeginPlay()
 	Super::BeginPlay();
 }
 
-// Called every frame
-void ACSShield::Tick(float DeltaTime)
+UMeshComponent* ACSShield::CreateMeshComponent(ACSCharacter* Character, FName SocketName) const
 {
-	Super::Tick(DeltaTime);
+	if (Character == nullptr) { return nullptr; }
+
+	UMeshComponent* ShieldMeshComp = nullptr;
+	if (StaticMesh)
+	{
+		UStaticMeshComponent* StaticMeshComp = NewObject<UStaticMeshComponent>(Character, TEXT("ShieldMeshComp"));
+		StaticMeshComp->SetStaticMesh(StaticMesh);
+		ShieldMeshComp = StaticMeshComp;
+	}
+	else
+	{
+		USkeletalMeshComponent* SkeletalMeshComp = NewObject<USkeletalMeshComponent>(Character, TEXT("ShieldMeshComp"));
+		SkeletalMeshComp->SetSkeletalMesh(MeshComp->GetSkeletalMeshAsset());
+		//The pose never changes, the mesh only follows the socket
+		SkeletalMeshComp->PrimaryComponentTick.bStartWithTickEnabled = false;
+		ShieldMeshComp = SkeletalMeshComp;
+	}
+
+	for (int32 i = 0; i < MeshComp->OverrideMaterials.Num(); i++)
+	{
+		ShieldMeshComp->SetMaterial(i, MeshComp->OverrideMaterials[i]);
+	}
+
+	ShieldMeshComp->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	ShieldMeshComp->SetGenerateOverlapEvents(false);
+	ShieldMeshComp->SetRelativeScale3D(MeshComp->GetRelativeScale3D());
+	ShieldMeshComp->SetupAttachment(Character->GetMesh(), SocketName);
+	ShieldMeshComp->RegisterComponent();
+
+	return ShieldMeshComp;
 }
 
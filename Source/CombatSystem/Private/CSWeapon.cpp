@@ -10,21 +10,32 @@
 ACSWeapon::ACSWeapon()
 {
 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bCanEverTick = false;
 
 	MeshComp = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("MeshComp"));
 	MeshComp->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 	RootComponent = MeshComp;
+
+	AnimatedMesh = false;
 }
 
 // Called when the game starts or when spawned
 void ACSWeapon::BeginPlay()
 {
 	Super::BeginPlay();
+
+	//The pose never changes, the mesh only follows the socket it is attached to
+	if (!AnimatedMesh)
+	{
+		MeshComp->SetComponentTickEnabled(false);
+	}
 }
 
-void ACSWeapon::PlayImpactEffects(EPhysicalSurface SurfaceType, FVector ImpactPoint)
-{}
+void ACSWeapon::GetImpactEffects(EPhysicalSurface SurfaceType, uint8 AttackSubstate, UNiagaraSystem*& OutImpactEffect, USoundBase*& OutImpactSound) const
+{
+	OutImpactEffect = nullptr;
+	OutImpactSound = nullptr;
+}
 
 void ACSWeapon::SetCharacter(ACSCharacter* NewCharacter)
 {
@@ -32,9 +43,12 @@ void ACSWeapon::SetCharacter(ACSCharacter* NewCharacter)
 	SetOwner(NewCharacter);
 }
 
-// Called every frame
-void ACSWeapon::Tick(float DeltaTime)
+float ACSWeapon::GetDamageAmount() const
 {
-	Super::Tick(DeltaTime);
+	return DamageAmount;
 }
 
+TSubclassOf<UDamageType> ACSWeapon::GetDamageType() const
+{
+	return DamageType;
+}
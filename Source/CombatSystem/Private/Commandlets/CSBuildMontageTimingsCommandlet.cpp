@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Commandlets/CSBuildMontageTimingsCommandlet.h"
+
+#include "Animation/CSMontageTimingTable.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Misc/PackageName.h"
+#include "UObject/SavePackage.h"
+
+UCSBuildMontageTimingsCommandlet::UCSBuildMontageTimingsCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UCSBuildMontageTimingsCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	TArray<FAssetData> TableAssets;
+	AssetRegistry.GetAssetsByClass(UCSMontageTimingTable::StaticClass()->GetClassPathName(), TableAssets, true);
+
+	int32 FailedTables = 0;
+	for (const FAssetData& AssetData : TableAssets)
+	{
+		UCSMontageTimingTable* Table = Cast<UCSMontageTimingTable>(AssetData.GetAsset());
+		if (Table == nullptr) { continue; }
+
+		Table->RebuildTimings();
+
+		UPackage* Package = Table->GetPackage();
+		FString PackageFilename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+
+		FSavePackageArgs SaveArgs;
+		SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+		if (!UPackage::SavePackage(Package, Table, *PackageFilename, SaveArgs))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Could not save %s"), *PackageFilename);
+			FailedTables++;
+		}
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Rebuilt %d montage timing tables, %d failed"), TableAssets.Num() - FailedTables, FailedTables);
+
+	return FailedTables > 0 ? 1 : 0;
+#else
+	return 1;
+#endif
+}
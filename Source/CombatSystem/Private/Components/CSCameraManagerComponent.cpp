@@ -5,6 +5,7 @@
 
 #include "CSCharacter.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
 #include "Camera/CameraComponent.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "Kismet/KismetMathLibrary.h"
@@ -180,22 +181,25 @@ void UCSCameraManagerComponent::SetTurnSpeed(float NewTurnSpeed)
 
 void UCSCameraManagerComponent::PlayCameraShake(TSubclassOf<UCameraShakeBase> CameraShake, float scale)
 {
-	if (!Character->IsPlayerControlled())
+	//Only the camera of the local player shakes, remote players shake their own
+	APlayerController* PlayerController = Cast<APlayerController>(Character->GetController());
+	if (PlayerController == nullptr || !PlayerController->IsLocalController())
 	{
 		return;
 	}
 
-	GetWorld()->GetFirstPlayerController()->ClientStartCameraShake(CameraShake, scale);
+	PlayerController->ClientStartCameraShake(CameraShake, scale);
 }
 
 void UCSCameraManagerComponent::StopCameraShake(TSubclassOf<UCameraShakeBase> CameraShake, bool StopImmediately)
 {
-	if (!Character->IsPlayerControlled())
+	APlayerController* PlayerController = Cast<APlayerController>(Character->GetController());
+	if (PlayerController == nullptr || !PlayerController->IsLocalController())
 	{
 		return;
 	}
 
-	GetWorld()->GetFirstPlayerController()->ClientStopCameraShake(CameraShake, StopImmediately);
+	PlayerController->ClientStopCameraShake(CameraShake, StopImmediately);
 }
 
 float UCSCameraManagerComponent::CalculateDesiredFOV(ACharacter* LockedEnemy, int32 NearbyEnemies)
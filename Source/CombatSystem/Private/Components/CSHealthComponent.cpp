@@ -6,14 +6,19 @@
 #include "Actions/CSCharacterState.h"
 #include "Actions/CSCharacterState_Hit.h"
 #include "Actions/CSCharacterState_Block.h"
+#include "GameFramework/DamageType.h"
+#include "TimerManager.h"
 
 // Sets default values for this component's properties
 UCSHealthComponent::UCSHealthComponent()
 {
-	PrimaryComponentTick.bCanEverTick = true;
+	//Health is evaluated when read, regeneration only schedules its notifications
+	PrimaryComponentTick.bCanEverTick = false;
 
 	MaxHealth = 100;
 	HealthRecuperationPerSecond = 0.0f;
+	RegenNotificationStep = 0.1f;
+	PendingHealthDelta = 0.0f;
 	Character = Cast<ACSCharacter>(GetOwner());
 }
 
@@ -25,7 +30,8 @@ void UCSHealthComponent::BeginPlay()
 
 	// ...
 
-	CurrentHealth = MaxHealth;
+	Health.Max = MaxHealth;
+	Health.Set(MaxHealth, 0.0f, GetWorld()->GetTimeSeconds());
 
 	AActor* MyOwner = GetOwner();
 	if (MyOwner)
@@ -34,54 +40,123 @@ void UCSHealthComponent::BeginPlay()
 	}
 }
 
-void UCSHealthComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+void UCSHealthComponent::HandleTakeAnyDamage(AActor* DamagedActor, float Damage, const UDamageType* DamageType, AController* InstigatedBy, AActor* DamageCauser)
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	//Damage applied through the engine by anything else than the combat weapons
+	FCSDamageEvent DamageEvent;
+	DamageEvent.DamageCauser = DamageCauser;
+	DamageEvent.DamageCauserLocation = DamageCauser ? DamageCauser->GetActorLocation() : GetOwner()->GetActorLocation();
+	DamageEvent.BaseDamage = Damage;
+	DamageEvent.DamageType = DamageType ? DamageType->GetClass() : nullptr;
 
-	if (Character->IsPlayerControlled())
-	{
-		if (CurrentHealth < MaxHealth && CurrentHealth > 0.0f)
-		{
-			CurrentHealth += HealthRecuperationPerSecond * DeltaTime;
+	ACSCharacter* DamagerCharacter = Cast<ACSCharacter>(DamageCauser);
+	if (!DamagerCharacter && DamageCauser) { DamagerCharacter = Cast<ACSCharacter>(DamageCauser->GetOwner()); }
+	DamageEvent.Attacker = DamagerCharacter;
 
-			Character->UpdateHealth(GetHealthPercentage());
-		}
-	}
+	ApplyCombatDamage(DamageEvent);
 }
 
-void UCSHealthComponent::HandleTakeAnyDamage(AActor* DamagedActor, float Damage, const UDamageType* DamageType, AController* InstigatedBy, AActor* DamageCauser)
+void UCSHealthComponent::ApplyCombatDamage(const FCSDamageEvent& DamageEvent)
 {
+	float Damage = DamageEvent.GetDamage();
 	if (Damage <= 0.0f || Invulnerable) { return; }
 
-	ACSCharacter* DamagerCharacter = Cast<ACSCharacter>(DamageCauser);
-	if (!DamagerCharacter) { DamagerCharacter = Cast<ACSCharacter>(DamageCauser->GetOwner()); }
+	ACSCharacter* DamagerCharacter = DamageEvent.Attacker.Get();
 
-	bool ImpactBlocked = false;
-	UCSCharacterState_Block* BlockState = Cast<UCSCharacterState_Block>(Character->GetCharacterState(CharacterStateType::BLOCK));
 	//Block
+	UCSCharacterState_Block* BlockState = Character->GetBlockState();
 	if (BlockState && Character->GetCurrentState() == CharacterStateType::BLOCK)
 	{
-		BlockState->OnImpact(Damage, DamageType, InstigatedBy, DamageCauser);
+		BlockState->OnImpact(Damage, DamageEvent);
 	}
 	//Default hit
 	else
 	{
-		if (Character->GetCurrentState() == CharacterStateType::HIT && Character->GetCurrentSubstate() == (uint8)CharacterSubstateType_Hit::PARRIED_HIT) 
+		UCSCharacterState_Hit* HitState = Character->GetHitState();
+		if (HitState)
 		{
-			UCSCharacterState_Hit* HitState = Cast< UCSCharacterState_Hit>(Character->GetCharacterState(CharacterStateType::HIT));
-			if (HitState) { Damage *= HitState->GetDamageMultiplier(); }
-		}
+			if (Character->GetCurrentState() == CharacterStateType::HIT && Character->GetCurrentSubstate() == (uint8)CharacterSubstateType_Hit::PARRIED_HIT)
+			{
+				Damage *= HitState->GetDamageMultiplier();
+			}
 
-		UCSCharacterState_Hit* HitState = Cast<UCSCharacterState_Hit>(Character->GetCharacterState(CharacterStateType::HIT));
-		if (HitState && DamagerCharacter)
-		{
-			HitState->SetDamageOrigin(DamagerCharacter->GetActorLocation());
+			if (DamagerCharacter) { HitState->SetDamageOrigin(DamagerCharacter->GetActorLocation()); }
 		}
 		Character->ChangeState(CharacterStateType::HIT, (uint8)CharacterSubstateType_Hit::DEFAULT_HIT);
 	}
 
-	CurrentHealth = FMath::Clamp(CurrentHealth - Damage, 0.0f, MaxHealth);
-	OnHealthChanged.Broadcast(this, CurrentHealth, Damage, DamageType, InstigatedBy, DamageCauser);
+	float Time = GetWorld()->GetTimeSeconds();
+	float CurrentHealth = FMath::Clamp(Health.Get(Time) - Damage, 0.0f, MaxHealth);
+	float RegenRate = CurrentHealth > 0.0f && Character->IsPlayerControlled() ? HealthRecuperationPerSecond : 0.0f;
+	Health.Set(CurrentHealth, RegenRate, Time);
+
+	Character->OnHealthChanged(DamageEvent, CurrentHealth);
+
+	QueueHealthChangedNotification(DamageEvent, Damage);
+	ScheduleRegenNotification();
+}
+
+void UCSHealthComponent::ScheduleRegenNotification()
+{
+	float Time = GetWorld()->GetTimeSeconds();
+	if (!Health.IsRegenerating(Time))
+	{
+		GetWorld()->GetTimerManager().ClearTimer(TimerHandle_RegenNotification);
+		return;
+	}
+
+	//Next step of the bar, or the end of the regeneration
+	float Delay = Health.GetTimeUntilNextStep(Time, RegenNotificationStep);
+
+	GetWorld()->GetTimerManager().SetTimer(TimerHandle_RegenNotification, this, &UCSHealthComponent::SendRegenNotification, Delay, false);
+}
+
+void UCSHealthComponent::SendRegenNotification()
+{
+	Character->SetUIHealth(GetHealthPercentage());
+
+	ScheduleRegenNotification();
+}
+
+void UCSHealthComponent::QueueHealthChangedNotification(const FCSDamageEvent& DamageEvent, float HealthDelta)
+{
+	PendingHealthDelta += HealthDelta;
+	LastDamageEvent = DamageEvent;
+
+	if (!TimerHandle_HealthChangedNotification.IsValid())
+	{
+		TimerHandle_HealthChangedNotification = GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UCSHealthComponent::SendHealthChangedNotification);
+	}
+}
+
+void UCSHealthComponent::SendHealthChangedNotification()
+{
+	TimerHandle_HealthChangedNotification.Invalidate();
+
+	Character->SetUIHealth(GetHealthPercentage());
+
+	if (OnHealthChanged.IsBound())
+	{
+		ACSCharacter* DamagerCharacter = LastDamageEvent.Attacker.Get();
+		const UDamageType* DamageType = LastDamageEvent.DamageType ? LastDamageEvent.DamageType->GetDefaultObject<UDamageType>() : nullptr;
+		OnHealthChanged.Broadcast(this, GetCurrentHealth(), PendingHealthDelta, DamageType, DamagerCharacter ? DamagerCharacter->GetController() : nullptr, LastDamageEvent.DamageCauser.Get());
+	}
+
+	PendingHealthDelta = 0.0f;
+	LastDamageEvent = FCSDamageEvent();
+}
+
+void UCSHealthComponent::ResetHealth()
+{
+	GetWorld()->GetTimerManager().ClearTimer(TimerHandle_RegenNotification);
+	GetWorld()->GetTimerManager().ClearTimer(TimerHandle_HealthChangedNotification);
+	TimerHandle_HealthChangedNotification.Invalidate();
+
+	PendingHealthDelta = 0.0f;
+	LastDamageEvent = FCSDamageEvent();
+	Invulnerable = false;
+
+	Health.Set(MaxHealth, 0.0f, GetWorld()->GetTimeSeconds());
 }
 
 bool UCSHealthComponent::IsInvulnerable() const
@@ -95,14 +170,14 @@ void UCSHealthComponent::SetInvulnerable(bool NewInvulnerable)
 	Invulnerable = NewInvulnerable;
 }
 
-float UCSHealthComponent::GetHealthPercentage()
+float UCSHealthComponent::GetHealthPercentage() const
 {
-	return CurrentHealth / MaxHealth;
+	return GetCurrentHealth() / MaxHealth;
 }
 
 float UCSHealthComponent::GetCurrentHealth() const
 {
-	return CurrentHealth;
+	return Health.Get(GetWorld()->GetTimeSeconds());
 }
 
 
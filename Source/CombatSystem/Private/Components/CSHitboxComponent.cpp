@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Components/CSHitboxComponent.h"
+
+#include "GameFramework/Character.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "../../CombatSystem.h"
+
+UCSHitboxComponent::UCSHitboxComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	LastUpdateFrame = 0;
+
+	//Default setup for the mixamo skeleton, override it in the character blueprint for other skeletons
+	FCSHitbox HeadHitbox;
+	HeadHitbox.BoneName = "mixamorig:Head";
+	HeadHitbox.EndOffset = FVector(0.0f, 15.0f, 0.0f);
+	HeadHitbox.Radius = 11.0f;
+	HeadHitbox.SurfaceType = SURFACE_FLESH_CRITICAL;
+	HeadHitbox.DamageMultiplier = 5.0f;
+	Hitboxes.Add(HeadHitbox);
+
+	FCSHitbox TorsoHitbox;
+	TorsoHitbox.BoneName = "mixamorig:Spine";
+	TorsoHitbox.EndOffset = FVector(0.0f, 35.0f, 0.0f);
+	TorsoHitbox.Radius = 18.0f;
+	TorsoHitbox.SurfaceType = SURFACE_FLESH;
+	Hitboxes.Add(TorsoHitbox);
+
+	//Limbs, mixamo bones point along Y towards their child
+	auto AddLimbHitbox = [this](FName BoneName, float Length, float Radius)
+	{
+		FCSHitbox LimbHitbox;
+		LimbHitbox.BoneName = BoneName;
+		LimbHitbox.EndOffset = FVector(0.0f, Length, 0.0f);
+		LimbHitbox.Radius = Radius;
+		LimbHitbox.SurfaceType = SURFACE_FLESH;
+		Hitboxes.Add(LimbHitbox);
+	};
+
+	AddLimbHitbox("mixamorig:LeftArm", 28.0f, 7.0f);
+	AddLimbHitbox("mixamorig:LeftForeArm", 26.0f, 6.0f);
+	AddLimbHitbox("mixamorig:RightArm", 28.0f, 7.0f);
+	AddLimbHitbox("mixamorig:RightForeArm", 26.0f, 6.0f);
+	AddLimbHitbox("mixamorig:LeftUpLeg", 42.0f, 10.0f);
+	AddLimbHitbox("mixamorig:LeftLeg", 40.0f, 8.0f);
+	AddLimbHitbox("mixamorig:RightUpLeg", 42.0f, 10.0f);
+	AddLimbHitbox("mixamorig:RightLeg", 40.0f, 8.0f);
+}
+
+void UCSHitboxComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	ACharacter* CharacterOwner = Cast<ACharacter>(GetOwner());
+	MeshComp = CharacterOwner ? CharacterOwner->GetMesh() : nullptr;
+
+	BoneIndices.SetNum(Hitboxes.Num());
+	WorldStarts.SetNum(Hitboxes.Num());
+	WorldEnds.SetNum(Hitboxes.Num());
+
+	for (int32 i = 0; i < Hitboxes.Num(); ++i)
+	{
+		BoneIndices[i] = MeshComp ? MeshComp->GetBoneIndex(Hitboxes[i].BoneName) : INDEX_NONE;
+		if (BoneIndices[i] == INDEX_NONE)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Hitbox bone %s not found on %s"), *Hitboxes[i].BoneName.ToString(), *GetOwner()->GetName());
+		}
+	}
+}
+
+void UCSHitboxComponent::UpdateHitboxes()
+{
+	if (LastUpdateFrame == GFrameCounter || MeshComp == nullptr) { return; }
+	LastUpdateFrame = GFrameCounter;
+
+	for (int32 i = 0; i < Hitboxes.Num(); ++i)
+	{
+		if (BoneIndices[i] == INDEX_NONE) { continue; }
+
+		FTransform BoneTransform = MeshComp->GetBoneTransform(BoneIndices[i]);
+		WorldStarts[i] = BoneTransform.TransformPosition(Hitboxes[i].StartOffset);
+		WorldEnds[i] = BoneTransform.TransformPosition(Hitboxes[i].EndOffset);
+	}
+}
+
+bool UCSHitboxComponent::IntersectSegment(const FVector& SegmentStart, const FVector& SegmentEnd, float SegmentRadius, FCSHitboxHit& OutHit)
+{
+	UpdateHitboxes();
+
+	FVector SegmentDirection = SegmentEnd - SegmentStart;
+	float SegmentLengthSquared = FMath::Max(SegmentDirection.SizeSquared(), KINDA_SMALL_NUMBER);
+
+	int32 FirstHitbox = INDEX_NONE;
+	float FirstHitAlpha = TNumericLimits<float>::Max();
+	for (int32 i = 0; i < Hitboxes.Num(); ++i)
+	{
+		if (BoneIndices[i] == INDEX_NONE) { continue; }
+
+		FVector PointOnSegment;
+		FVector PointOnHitbox;
+		FMath::SegmentDistToSegmentSafe(SegmentStart, SegmentEnd, WorldStarts[i], WorldEnds[i], PointOnSegment, PointOnHitbox);
+
+		float CombinedRadius = Hitboxes[i].Radius + SegmentRadius;
+		if (FVector::DistSquared(PointOnSegment, PointOnHitbox) > CombinedRadius * CombinedRadius) { continue; }
+
+		float HitAlpha = FVector::DotProduct(PointOnSegment - SegmentStart, SegmentDirection) / SegmentLengthSquared;
+		if (HitAlpha < FirstHitAlpha)
+		{
+			FirstHitAlpha = HitAlpha;
+			FirstHitbox = i;
+			OutHit.ImpactPoint = PointOnHitbox + (PointOnSegment - PointOnHitbox).GetSafeNormal() * Hitboxes[i].Radius;
+		}
+	}
+
+	if (FirstHitbox == INDEX_NONE) { return false; }
+
+	OutHit.SurfaceType = Hitboxes[FirstHitbox].SurfaceType;
+	OutHit.DamageMultiplier = Hitboxes[FirstHitbox].DamageMultiplier;
+	return true;
+}
+
+bool UCSHitboxComponent::FindClosestHitbox(const FVector& Point, FCSHitboxHit& OutHit)
+{
+	UpdateHitboxes();
+
+	int32 ClosestHitbox = INDEX_NONE;
+	float ClosestDistance = TNumericLimits<float>::Max();
+	for (int32 i = 0; i < Hitboxes.Num(); ++i)
+	{
+		if (BoneIndices[i] == INDEX_NONE) { continue; }
+
+		FVector PointOnHitbox = FMath::ClosestPointOnSegment(Point, WorldStarts[i], WorldEnds[i]);
+		float Distance = FVector::Dist(Point, PointOnHitbox) - Hitboxes[i].Radius;
+		if (Distance < ClosestDistance)
+		{
+			ClosestDistance = Distance;
+			ClosestHitbox = i;
+			OutHit.ImpactPoint = PointOnHitbox + (Point - PointOnHitbox).GetSafeNormal() * Hitboxes[i].Radius;
+		}
+	}
+
+	if (ClosestHitbox == INDEX_NONE) { return false; }
+
+	OutHit.SurfaceType = Hitboxes[ClosestHitbox].SurfaceType;
+	OutHit.DamageMultiplier = Hitboxes[ClosestHitbox].DamageMultiplier;
+	return true;
+}
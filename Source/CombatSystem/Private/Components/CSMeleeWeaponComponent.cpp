@@ -0,0 +1,204 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Components/CSMeleeWeaponComponent.h"
+
+#include "CSCharacter.h"
+#include "Equipment/CSMeleeWeapon.h"
+#include "Components/BoxComponent.h"
+#include "Components/CSHealthComponent.h"
+#include "Components/CSHitboxComponent.h"
+#include "Actions/CSCharacterState.h"
+#include "Actions/CSCharacterState_Attack.h"
+#include "Subsystems/CSHitResolutionSubsystem.h"
+#include "../../CombatSystem.h"
+
+#include "DrawDebugHelpers.h"
+
+static int32 MeleeWeaponDebugDraw = 0;
+FAutoConsoleVariableRef CVARMeleeWeaponDebugDraw(
+	TEXT("CS.MeleeWeaponDebugDraw"),
+	MeleeWeaponDebugDraw,
+	TEXT("Draw all melee weapon sweeps"),
+	ECVF_Cheat);
+
+UCSMeleeWeaponComponent::UCSMeleeWeaponComponent()
+{
+	//Only ticks between the EnableDamage and DisableDamage notifies
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+
+	Character = Cast<ACSCharacter>(GetOwner());
+
+	DamageEnabled = false;
+}
+
+void UCSMeleeWeaponComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	//Sweep from the blade pose after the character animation has moved it
+	if (Character) { AddTickPrerequisiteComponent(Character->GetMesh()); }
+}
+
+void UCSMeleeWeaponComponent::SetWeapon(ACSMeleeWeapon* NewWeapon)
+{
+	SetDamageEnabled(false);
+	Weapon = NewWeapon;
+}
+
+ACSMeleeWeapon* UCSMeleeWeaponComponent::GetWeapon() const
+{
+	return Weapon;
+}
+
+void UCSMeleeWeaponComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (DamageEnabled)
+	{
+		SweepBlade();
+	}
+}
+
+void UCSMeleeWeaponComponent::SetDamageEnabled(bool Enabled)
+{
+	if (Enabled == DamageEnabled) { return; }
+	if (Enabled && (Character == nullptr || Weapon == nullptr)) { return; }
+
+	DamageEnabled = Enabled;
+
+	if (DamageEnabled)
+	{
+		SwingHitActors.Reset();
+		LastBladeTransform = GetBladeTransform();
+	}
+
+	SetComponentTickEnabled(DamageEnabled);
+}
+
+FTransform UCSMeleeWeaponComponent::GetBladeTransform() const
+{
+	//Without animation on the server the weapon socket follows the trajectory sampled from the montage
+	if (Character->IsUsingMontageTimings())
+	{
+		return Weapon->GetBladeComponent()->GetRelativeTransform() * Weapon->GetRootComponent()->GetRelativeTransform() * Character->GetCombatSocketTransform(Weapon->GetAttachParentSocketName());
+	}
+
+	return Weapon->GetBladeComponent()->GetComponentTransform();
+}
+
+void UCSMeleeWeaponComponent::SweepBlade()
+{
+	if (Weapon == nullptr) { return; }
+
+	const UBoxComponent* BladeComp = Weapon->GetBladeComponent();
+	FTransform CurrentBladeTransform = GetBladeTransform();
+
+	//Split the sweep depending on how much the blade rotated since the last frame so fast swings don't tunnel through targets
+	float SweptAngle = FMath::RadiansToDegrees((CurrentBladeTransform.GetRotation() * LastBladeTransform.GetRotation().Inverse()).GetAngle());
+	int32 Substeps = FMath::Clamp(FMath::CeilToInt(SweptAngle / FMath::Max(Weapon->GetMaxSweepSubstepAngle(), 1.0f)), 1, FMath::Max(Weapon->GetMaxSweepSubsteps(), 1));
+
+	FCollisionShape BladeShape = FCollisionShape::MakeBox(BladeComp->GetScaledBoxExtent());
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(MeleeWeaponSweep), false, Weapon);
+	QueryParams.AddIgnoredActor(GetOwner());
+
+	FCollisionResponseParams ResponseParams(BladeComp->GetCollisionResponseToChannels());
+
+	TArray<FHitResult> Hits;
+	for (int32 i = 0; i < Substeps; ++i)
+	{
+		float StartAlpha = (float)i / Substeps;
+		float EndAlpha = (float)(i + 1) / Substeps;
+
+		FVector SweepStart = FMath::Lerp(LastBladeTransform.GetLocation(), CurrentBladeTransform.GetLocation(), StartAlpha);
+		FVector SweepEnd = FMath::Lerp(LastBladeTransform.GetLocation(), CurrentBladeTransform.GetLocation(), EndAlpha);
+		FQuat SweepRotation = FQuat::Slerp(LastBladeTransform.GetRotation(), CurrentBladeTransform.GetRotation(), (StartAlpha + EndAlpha) * 0.5f);
+
+		Hits.Reset();
+		GetWorld()->SweepMultiByChannel(Hits, SweepStart, SweepEnd, SweepRotation, BladeComp->GetCollisionObjectType(), BladeShape, QueryParams, ResponseParams);
+
+		if (MeleeWeaponDebugDraw > 0)
+		{
+			DrawDebugBox(GetWorld(), SweepEnd, BladeShape.GetExtent(), SweepRotation, Hits.Num() > 0 ? FColor::Red : FColor::White, false, 1.0f);
+		}
+
+		FTransform SubstepBladeTransform(SweepRotation, SweepEnd, CurrentBladeTransform.GetScale3D());
+		for (const FHitResult& Hit : Hits)
+		{
+			OnBladeHit(Hit, SubstepBladeTransform);
+		}
+	}
+
+	LastBladeTransform = CurrentBladeTransform;
+}
+
+void UCSMeleeWeaponComponent::OnBladeHit(const FHitResult& Hit, const FTransform& BladeTransform)
+{
+	AActor* OtherActor = Hit.GetActor();
+	if (OtherActor == nullptr || OtherActor == GetOwner() || OtherActor->GetOwner() == GetOwner()) { return; }
+
+	//Each target is only hit once per swing
+	if (SwingHitActors.Contains(OtherActor)) { return; }
+	SwingHitActors.Add(OtherActor);
+
+	ACSCharacter* OtherCharacter = Cast<ACSCharacter>(OtherActor);
+	EPhysicalSurface ImpactedSurface = OtherCharacter ? SURFACE_FLESH : EPhysicalSurface::SurfaceType3;
+	FVector ImpactPoint = Hit.bStartPenetrating ? OtherActor->GetActorLocation() : FVector(Hit.ImpactPoint);
+	float ZoneDamageMultiplier = 1.0f;
+
+	//The hit zone is the hitbox closest to where the blade touched, or to the blade itself when it started inside the target
+	if (OtherCharacter && OtherCharacter->GetHitboxComponent())
+	{
+		FCSHitboxHit HitboxHit;
+		if (OtherCharacter->GetHitboxComponent()->FindClosestHitbox(Hit.bStartPenetrating ? BladeTransform.GetLocation() : FVector(Hit.ImpactPoint), HitboxHit))
+		{
+			ImpactedSurface = HitboxHit.SurfaceType;
+			ImpactPoint = HitboxHit.ImpactPoint;
+			ZoneDamageMultiplier = HitboxHit.DamageMultiplier;
+		}
+	}
+
+	FCSHitRecord HitRecord;
+	HitRecord.Victim = OtherActor;
+	HitRecord.DamageEvent.Attacker = Character;
+	HitRecord.DamageEvent.DamageCauser = Weapon;
+	HitRecord.DamageEvent.BaseDamage = Weapon->GetDamageAmount();
+	HitRecord.DamageEvent.DamageMultiplier = ZoneDamageMultiplier;
+	HitRecord.DamageEvent.SurfaceType = ImpactedSurface;
+	HitRecord.DamageEvent.bHasImpactPoint = true;
+	HitRecord.DamageEvent.ImpactPoint = ImpactPoint;
+	HitRecord.DamageEvent.ImpactNormal = Hit.ImpactNormal;
+	HitRecord.DamageEvent.DamageType = Weapon->GetDamageType();
+
+	//Only characters that can take the hit deal damage and give the attacker its strike feedback
+	HitRecord.bDealsDamage = OtherCharacter && !OtherCharacter->GetHealthComponent()->IsInvulnerable();
+	HitRecord.bNotifyAttacker = HitRecord.bDealsDamage;
+
+	HitRecord.DamageEvent.AttackSubstate = Character->GetCurrentSubstate();
+
+	UCSCharacterState_Attack* AttackState = Cast<UCSCharacterState_Attack>(Character->GetCharacterState(CharacterStateType::ATTACK));
+	if (AttackState)
+	{
+		HitRecord.DamageEvent.DamageMultiplier *= AttackState->GetDamageMultiplier();
+	}
+
+#if CS_WITH_COSMETICS
+	if (CSAreCosmeticsEnabled(GetWorld()))
+	{
+		UNiagaraSystem* ImpactEffect = nullptr;
+		USoundBase* ImpactSound = nullptr;
+		Weapon->GetImpactEffects(ImpactedSurface, HitRecord.DamageEvent.AttackSubstate, ImpactEffect, ImpactSound);
+		HitRecord.ImpactEffect = ImpactEffect;
+		HitRecord.ImpactSound = ImpactSound;
+	}
+#endif
+
+	UCSHitResolutionSubsystem* HitResolution = GetWorld()->GetSubsystem<UCSHitResolutionSubsystem>();
+	if (HitResolution)
+	{
+		HitResolution->AddHit(MoveTemp(HitRecord));
+	}
+}
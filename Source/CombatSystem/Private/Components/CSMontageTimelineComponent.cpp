@@ -0,0 +1,143 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Components/CSMontageTimelineComponent.h"
+
+#include "CSCharacter.h"
+#include "Animation/CSMontageTimingTable.h"
+#include "Animation/AnimMontage.h"
+#include "Components/SkeletalMeshComponent.h"
+
+static int32 UseMontageTimingTable = 1;
+FAutoConsoleVariableRef CVARUseMontageTimingTable(
+	TEXT("CS.UseMontageTimingTable"),
+	UseMontageTimingTable,
+	TEXT("Drive combat timing from the montage timing table on dedicated servers instead of ticking animation"),
+	ECVF_Cheat);
+
+UCSMontageTimelineComponent::UCSMontageTimelineComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	TimingTable = nullptr;
+	Character = nullptr;
+
+	UseTimings = false;
+
+	CurrentMontage = nullptr;
+	CurrentTiming = nullptr;
+	CurrentPosition = 0.0f;
+	CurrentPlayRate = 1.0f;
+	NextNotifyIndex = 0;
+	TimelineSerial = 0u;
+}
+
+void UCSMontageTimelineComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Character = Cast<ACSCharacter>(GetOwner());
+
+	UseTimings = UseMontageTimingTable > 0 && TimingTable && Character && GetNetMode() == NM_DedicatedServer;
+	if (UseTimings)
+	{
+		//Nothing is rendered on the server so the pose is never evaluated, the table replaces the notifies and sockets
+		Character->GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+	}
+}
+
+void UCSMontageTimelineComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (CurrentTiming == nullptr)
+	{
+		StopTimeline();
+		return;
+	}
+
+	CurrentPosition += DeltaTime * CurrentPlayRate;
+
+	const FCSMontageTiming* PlayingTiming = CurrentTiming;
+	uint32 PlayingSerial = TimelineSerial;
+	while (NextNotifyIndex < PlayingTiming->Notifies.Num() && PlayingTiming->Notifies[NextNotifyIndex].Time <= CurrentPosition)
+	{
+		FName NotifyName = PlayingTiming->Notifies[NextNotifyIndex].NotifyName;
+		NextNotifyIndex++;
+
+		Character->OnMontageTimelineNotify(NotifyName);
+
+		//The notify started or stopped a montage, the rest of the old timeline must not fire
+		if (TimelineSerial != PlayingSerial) { return; }
+	}
+
+	if (CurrentPosition >= CurrentTiming->Length)
+	{
+		StopTimeline();
+	}
+}
+
+bool UCSMontageTimelineComponent::IsUsingTimings() const
+{
+	return UseTimings;
+}
+
+void UCSMontageTimelineComponent::OnMontagePlayed(UAnimMontage* Montage, float PlayRate, FName StartSectionName)
+{
+	if (!UseTimings || Montage == nullptr) { return; }
+
+	TimelineSerial++;
+	CurrentTiming = TimingTable->FindTiming(Montage);
+	if (CurrentTiming == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s has no timings in %s"), *Montage->GetName(), *TimingTable->GetName());
+		StopTimeline();
+		return;
+	}
+
+	CurrentMontage = Montage;
+	CurrentPlayRate = PlayRate * Montage->RateScale;
+	CurrentPosition = 0.0f;
+
+	int32 SectionIndex = StartSectionName.IsNone() ? INDEX_NONE : Montage->GetSectionIndex(StartSectionName);
+	if (SectionIndex != INDEX_NONE)
+	{
+		CurrentPosition = Montage->GetAnimCompositeSection(SectionIndex).GetTime();
+	}
+
+	NextNotifyIndex = 0;
+	while (NextNotifyIndex < CurrentTiming->Notifies.Num() && CurrentTiming->Notifies[NextNotifyIndex].Time < CurrentPosition)
+	{
+		NextNotifyIndex++;
+	}
+
+	SetComponentTickEnabled(true);
+}
+
+void UCSMontageTimelineComponent::OnMontageStopped(UAnimMontage* Montage)
+{
+	if (Montage == nullptr || Montage == CurrentMontage)
+	{
+		StopTimeline();
+	}
+}
+
+void UCSMontageTimelineComponent::StopTimeline()
+{
+	TimelineSerial++;
+	CurrentMontage = nullptr;
+	CurrentTiming = nullptr;
+
+	SetComponentTickEnabled(false);
+}
+
+bool UCSMontageTimelineComponent::GetSocketTransform(FName SocketName, FTransform& OutTransform) const
+{
+	if (CurrentTiming == nullptr) { return false; }
+
+	FTransform ComponentSpaceTransform;
+	if (!CurrentTiming->SampleSocket(SocketName, CurrentPosition, ComponentSpaceTransform)) { return false; }
+
+	OutTransform = ComponentSpaceTransform * Character->GetMesh()->GetComponentTransform();
+	return true;
+}
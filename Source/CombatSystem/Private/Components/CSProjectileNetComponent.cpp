@@ -0,0 +1,311 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Components/CSProjectileNetComponent.h"
+
+#include "CSCharacter.h"
+#include "CSProjectile.h"
+#include "Equipment/CSRangedWeapon.h"
+#include "Subsystems/CSHitResolutionSubsystem.h"
+#include "Engine/NetDriver.h"
+#include "Serialization/BitWriter.h"
+#include "Chaos/ChaosEngineInterface.h"
+#include "NiagaraSystem.h"
+#include "Sound/SoundBase.h"
+
+//Payload sent for the arrows of this process, RPC headers are not included
+struct FCSProjectileNetStats
+{
+	int32 Arrows = 0;
+	int64 ClientToServerBits = 0;
+	int64 ServerToClientBits = 0;
+};
+
+static FCSProjectileNetStats ProjectileNetStats;
+
+template<typename ParamsType>
+static int64 GetSerializedBits(const ParamsType& Params)
+{
+	ParamsType ParamsCopy = Params;
+	FBitWriter Writer(256, true);
+	bool bSuccess = true;
+	ParamsCopy.NetSerialize(Writer, nullptr, bSuccess);
+	return Writer.GetNumBits();
+}
+
+static int32 GetClientConnectionCount(const UWorld* World)
+{
+	UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+	return NetDriver ? NetDriver->ClientConnections.Num() : 0;
+}
+
+static void LogProjectileNetStats(const TArray<FString>& Args)
+{
+	if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+	{
+		ProjectileNetStats = FCSProjectileNetStats();
+		UE_LOG(LogTemp, Log, TEXT("Projectile net stats reset"));
+		return;
+	}
+
+	int32 Arrows = FMath::Max(ProjectileNetStats.Arrows, 1);
+	UE_LOG(LogTemp, Log, TEXT("Projectile net stats: %d arrows, client to server %.1f bytes per arrow, server to clients %.1f bytes per arrow (spawn params %lld bits, hit params %lld bits)"),
+		ProjectileNetStats.Arrows,
+		ProjectileNetStats.ClientToServerBits / 8.0 / Arrows,
+		ProjectileNetStats.ServerToClientBits / 8.0 / Arrows,
+		GetSerializedBits(FCSProjectileSpawnParams()),
+		GetSerializedBits(FCSProjectileHitParams()));
+}
+
+FAutoConsoleCommand CVARProjectileNetStats(
+	TEXT("CS.ProjectileNetStats"),
+	TEXT("CS.ProjectileNetStats [reset]: logs the bytes sent per networked arrow since the last reset"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&LogProjectileNetStats),
+	ECVF_Cheat);
+
+void FCSProjectileSpawnParams::SetCharge(float Charge)
+{
+	QuantizedCharge = (uint8)FMath::RoundToInt(FMath::Clamp(Charge / MaxCharge, 0.0f, 1.0f) * 255.0f);
+}
+
+float FCSProjectileSpawnParams::GetCharge() const
+{
+	return QuantizedCharge / 255.0f * MaxCharge;
+}
+
+bool FCSProjectileSpawnParams::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = true;
+
+	Ar << ProjectileId;
+	Origin.NetSerialize(Ar, Map, bOutSuccess);
+	Direction.NetSerialize(Ar, Map, bOutSuccess);
+	Ar << QuantizedCharge;
+	Ar << Seed;
+
+	return true;
+}
+
+bool FCSProjectileHitParams::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = true;
+
+	Ar << ProjectileId;
+	ImpactPoint.NetSerialize(Ar, Map, bOutSuccess);
+	ImpactNormal.NetSerialize(Ar, Map, bOutSuccess);
+	Ar << SurfaceType;
+
+	uint8 StuckBit = Stuck ? 1 : 0;
+	Ar.SerializeBits(&StuckBit, 1);
+	Stuck = StuckBit != 0;
+
+	return true;
+}
+
+UCSProjectileNetComponent::UCSProjectileNetComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	SetIsReplicatedByDefault(true);
+
+	LastProjectileId = 0;
+	MaxOriginError = 200.0f;
+	MaxAimError = 30.0f;
+	MaxChargeTimeError = 0.1f;
+
+	ServerChargeStartTime = -1.0f;
+	LastServerShotTime = -BIG_NUMBER;
+}
+
+void UCSProjectileNetComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Character = Cast<ACSCharacter>(GetOwner());
+}
+
+bool UCSProjectileNetComponent::IsNetworked() const
+{
+	return GetNetMode() != NM_Standalone;
+}
+
+void UCSProjectileNetComponent::StartCharge()
+{
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		ServerStartCharge_Implementation();
+		return;
+	}
+
+	ServerStartCharge();
+}
+
+void UCSProjectileNetComponent::ServerStartCharge_Implementation()
+{
+	ServerChargeStartTime = GetWorld()->GetTimeSeconds();
+}
+
+void UCSProjectileNetComponent::FireProjectile(FCSProjectileSpawnParams Params)
+{
+	//0 is left for arrows that are not networked
+	LastProjectileId = LastProjectileId == MAX_uint16 ? 1 : LastProjectileId + 1;
+	Params.ProjectileId = LastProjectileId;
+
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		SpawnProjectile(Params, false);
+		MulticastProjectileFired(Params);
+		return;
+	}
+
+	//The shooter doesn't wait for the server to see its arrow
+	SpawnProjectile(Params, true);
+	ServerFireProjectile(Params);
+
+	ProjectileNetStats.ClientToServerBits += GetSerializedBits(Params);
+}
+
+void UCSProjectileNetComponent::ServerFireProjectile_Implementation(const FCSProjectileSpawnParams& Params)
+{
+	ACSRangedWeapon* RangedWeapon = Character ? Character->SpawnRangedWeapon() : nullptr;
+	if (RangedWeapon == nullptr) { return; }
+
+	//Shots sent faster than the bow can be drawn are dropped, the cosmetic arrow of the client just never gets a hit
+	float Time = GetWorld()->GetTimeSeconds();
+	if (Time - LastServerShotTime < RangedWeapon->GetMinTimeBetweenShots()) { return; }
+	LastServerShotTime = Time;
+
+	//The client decides the direction but the arrow has to leave from its bow
+	FCSProjectileSpawnParams ServerParams = Params;
+	FVector ServerOrigin = RangedWeapon->GetProjectileSpawnLocation();
+	if (FVector::DistSquared(ServerOrigin, Params.Origin) > FMath::Square(MaxOriginError))
+	{
+		ServerParams.Origin = ServerOrigin;
+	}
+
+	//The charge can't be more than the time the server saw the bow drawn
+	float ServerChargeTime = ServerChargeStartTime >= 0.0f ? Time - ServerChargeStartTime + MaxChargeTimeError : 0.0f;
+	ServerChargeStartTime = -1.0f;
+	if (RangedWeapon->GetMaxChargeTime() > 0.0f)
+	{
+		ServerParams.SetCharge(FMath::Min(Params.GetCharge(), ServerChargeTime / RangedWeapon->GetMaxChargeTime()));
+	}
+
+	//The arrow is kept in a cone around where the client looks
+	FVector AimDirection = Character->GetBaseAimRotation().Vector();
+	FVector Direction = Params.Direction.GetSafeNormal();
+	float AimError = FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(FVector::DotProduct(Direction, AimDirection), -1.0f, 1.0f)));
+	if (AimError > MaxAimError)
+	{
+		FQuat AimCorrection = FQuat::Slerp(FQuat::Identity, FQuat::FindBetweenNormals(AimDirection, Direction), MaxAimError / AimError);
+		ServerParams.Direction = AimCorrection.RotateVector(AimDirection);
+	}
+
+	SpawnProjectile(ServerParams, false);
+	MulticastProjectileFired(ServerParams);
+
+	//Listen servers hear the shots of the clients, the multicast stops on the server
+	RangedWeapon->PlayShootSound();
+}
+
+void UCSProjectileNetComponent::MulticastProjectileFired_Implementation(const FCSProjectileSpawnParams& Params)
+{
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		ProjectileNetStats.ServerToClientBits += GetSerializedBits(Params) * GetClientConnectionCount(GetWorld());
+		return;
+	}
+
+	//Already predicted by the shooter
+	if (Character && Character->IsLocallyControlled()) { return; }
+
+	SpawnProjectile(Params, true);
+
+	ACSRangedWeapon* RangedWeapon = Character ? Character->SpawnRangedWeapon() : nullptr;
+	if (RangedWeapon) { RangedWeapon->PlayShootSound(); }
+}
+
+void UCSProjectileNetComponent::OnAuthoritativeImpact(const FCSProjectileHitParams& Params)
+{
+	MulticastProjectileHit(Params);
+}
+
+void UCSProjectileNetComponent::MulticastProjectileHit_Implementation(const FCSProjectileHitParams& Params)
+{
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		ProjectileNetStats.ServerToClientBits += GetSerializedBits(Params) * GetClientConnectionCount(GetWorld());
+		return;
+	}
+
+	//The cosmetic arrow is moved to where the server one ended, if it didn't stop on its own yet
+	ACSProjectile* Projectile = FindCosmeticProjectile(Params.ProjectileId);
+	CosmeticProjectiles.Remove(Params.ProjectileId);
+	if (Projectile)
+	{
+		Projectile->ApplyAuthoritativeImpact(Params.ImpactPoint, Params.ImpactNormal, Params.Stuck);
+	}
+
+	//Impact effects only play from the server result so they match the hit that dealt the damage
+	ACSRangedWeapon* RangedWeapon = Character ? Character->SpawnRangedWeapon() : nullptr;
+	TSubclassOf<ACSProjectile> ProjectileClass = RangedWeapon ? RangedWeapon->GetProjectileClass() : nullptr;
+	const ACSProjectile* ProjectileDefaults = ProjectileClass ? ProjectileClass->GetDefaultObject<ACSProjectile>() : nullptr;
+	if (ProjectileDefaults == nullptr) { return; }
+
+	UNiagaraSystem* ImpactEffect = nullptr;
+	USoundBase* ImpactSound = nullptr;
+	ProjectileDefaults->GetImpactEffects((EPhysicalSurface)Params.SurfaceType, ImpactEffect, ImpactSound);
+
+	FCSHitRecord HitRecord;
+	HitRecord.DamageEvent.Attacker = Character;
+	HitRecord.DamageEvent.SurfaceType = (EPhysicalSurface)Params.SurfaceType;
+	HitRecord.DamageEvent.ImpactPoint = Params.ImpactPoint;
+	HitRecord.DamageEvent.ImpactNormal = Params.ImpactNormal;
+	HitRecord.ImpactEffect = ImpactEffect;
+	HitRecord.ImpactSound = ImpactSound;
+
+	UCSHitResolutionSubsystem* HitResolution = GetWorld()->GetSubsystem<UCSHitResolutionSubsystem>();
+	if (HitResolution)
+	{
+		HitResolution->AddHit(MoveTemp(HitRecord));
+	}
+}
+
+void UCSProjectileNetComponent::SpawnProjectile(const FCSProjectileSpawnParams& Params, bool Cosmetic)
+{
+	ACSRangedWeapon* RangedWeapon = Character ? Character->SpawnRangedWeapon() : nullptr;
+	if (RangedWeapon == nullptr) { return; }
+
+	ACSProjectile* Projectile = RangedWeapon->SpawnProjectile(Params, Cosmetic);
+
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		ProjectileNetStats.Arrows++;
+	}
+	else if (Projectile)
+	{
+		RemoveFinishedCosmeticProjectiles();
+		CosmeticProjectiles.Add(Params.ProjectileId, Projectile);
+	}
+}
+
+ACSProjectile* UCSProjectileNetComponent::FindCosmeticProjectile(uint16 ProjectileId) const
+{
+	const TWeakObjectPtr<ACSProjectile>* Projectile = CosmeticProjectiles.Find(ProjectileId);
+	if (Projectile == nullptr || !Projectile->IsValid()) { return nullptr; }
+
+	//Pooled arrows can be reused by another shot before the hit arrives
+	ACSProjectile* CosmeticProjectile = Projectile->Get();
+	return CosmeticProjectile->IsInUse() && CosmeticProjectile->GetNetId() == ProjectileId ? CosmeticProjectile : nullptr;
+}
+
+void UCSProjectileNetComponent::RemoveFinishedCosmeticProjectiles()
+{
+	//Hits are unreliable, forget the arrows that went back to their pool without one
+	for (auto It = CosmeticProjectiles.CreateIterator(); It; ++It)
+	{
+		if (FindCosmeticProjectile(It.Key()) == nullptr)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
@@ -2,16 +2,19 @@
 #include "Components/CSStaminaComponent.h"
 
 #include "CSCharacter.h"
+#include "TimerManager.h"
 
 // Sets default values for this component's properties
 UCSStaminaComponent::UCSStaminaComponent()
 {
-	PrimaryComponentTick.bCanEverTick = true;
+	//Stamina is evaluated when read, regeneration only schedules its notifications
+	PrimaryComponentTick.bCanEverTick = false;
 
 	Character = Cast<ACSCharacter>(GetOwner());
 
 	MaxStamina = 100.0f;
 	StaminaRecuperationPerSecond = 3.0f;
+	RegenNotificationStep = 0.1f;
 }
 
 
@@ -20,35 +23,60 @@ void UCSStaminaComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
-	CurrentStamina = MaxStamina;
+	Stamina.Max = MaxStamina;
+	Stamina.Set(MaxStamina, StaminaRecuperationPerSecond, GetWorld()->GetTimeSeconds());
 }
 
-void UCSStaminaComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+bool UCSStaminaComponent::HasEnoughStamina(float DesiredStaminaConsumption)
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	return (GetCurrentStamina() - DesiredStaminaConsumption) > 0.0f;
+}
 
-	if (CurrentStamina < MaxStamina)
-	{
-		CurrentStamina += StaminaRecuperationPerSecond * DeltaTime;
+void UCSStaminaComponent::ConsumeStamina(float StaminaToConsume)
+{
+	float Time = GetWorld()->GetTimeSeconds();
+	Stamina.Set(Stamina.Get(Time) - StaminaToConsume, StaminaRecuperationPerSecond, Time);
 
-		Character->UpdateStamina(GetStaminaPercentage());
-	}
+	Character->SetUIStamina(GetStaminaPercentage());
+
+	ScheduleRegenNotification();
 }
 
-bool UCSStaminaComponent::HasEnoughStamina(float DesiredStaminaConsumption)
+void UCSStaminaComponent::ResetStamina()
 {
-	return (CurrentStamina - DesiredStaminaConsumption) > 0.0f;
+	GetWorld()->GetTimerManager().ClearTimer(TimerHandle_RegenNotification);
+
+	Stamina.Set(MaxStamina, StaminaRecuperationPerSecond, GetWorld()->GetTimeSeconds());
 }
 
-void UCSStaminaComponent::ConsumeStamina(float StaminaToConsume)
+void UCSStaminaComponent::ScheduleRegenNotification()
 {
-	CurrentStamina = FMath::Clamp(CurrentStamina - StaminaToConsume, 0.0f, MaxStamina);
+	float Time = GetWorld()->GetTimeSeconds();
+	if (!Stamina.IsRegenerating(Time))
+	{
+		GetWorld()->GetTimerManager().ClearTimer(TimerHandle_RegenNotification);
+		return;
+	}
+
+	//Next step of the bar, or the end of the regeneration
+	float Delay = Stamina.GetTimeUntilNextStep(Time, RegenNotificationStep);
 
-	Character->UpdateStamina(GetStaminaPercentage());
+	GetWorld()->GetTimerManager().SetTimer(TimerHandle_RegenNotification, this, &UCSStaminaComponent::SendRegenNotification, Delay, false);
 }
 
-float UCSStaminaComponent::GetStaminaPercentage() const
+void UCSStaminaComponent::SendRegenNotification()
+{
+	Character->SetUIStamina(GetStaminaPercentage());
+
+	ScheduleRegenNotification();
+}
+
+float UCSStaminaComponent::GetCurrentStamina() const
 {
-	return CurrentStamina / MaxStamina;
+	return Stamina.Get(GetWorld()->GetTimeSeconds());
 }
 
+float UCSStaminaComponent::GetStaminaPercentage() const
+{
+	return GetCurrentStamina() / MaxStamina;
+}
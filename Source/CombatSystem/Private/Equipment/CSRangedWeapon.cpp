@@ -5,6 +5,12 @@
 
 #include "CSCharacter.h"
 #include "CSProjectile.h"
+#include "Actions/CSCharacterState.h"
+#include "Subsystems/CSCharacterRegistry.h"
+#include "Subsystems/CSProjectilePoolSubsystem.h"
+#include "Subsystems/CSProjectileSimulationSubsystem.h"
+#include "Subsystems/CSCombatAudioSubsystem.h"
+#include "Components/CSProjectileNetComponent.h"
 #include "Components/BoxComponent.h"
 #include "../../CombatSystem.h"
 
@@ -24,72 +30,163 @@ ACSRangedWeapon::ACSRangedWeapon()
 {
 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	//PrimaryActorTick.bCanEverTick = true;
+
+	//The string is drawn by the bow animation
+	AnimatedMesh = true;
+
+	AimAssistConeAngle = 5.0f;
+	AimAssistStrength = 0.0f;
+
+	PrewarmedProjectiles = 10;
+	MaxProjectiles = 64;
+
+	SpreadAngle = 0.0f;
+
+	MinTimeBetweenShots = 0.3f;
 }
 
 // Called when the game starts or when spawned
 void ACSRangedWeapon::BeginPlay()
 {
 	Super::BeginPlay();
+
+	UCSProjectilePoolSubsystem* ProjectilePool = GetWorld()->GetSubsystem<UCSProjectilePoolSubsystem>();
+	if (ProjectilePool)
+	{
+		ProjectilePool->PrewarmPool(DefaultProjectileClass, PrewarmedProjectiles, MaxProjectiles);
+	}
 }
 
 void ACSRangedWeapon::StartRecoiling()
 {
 	GetWorldTimerManager().SetTimer(TimerHandle_ChargeTimer, this, &ACSRangedWeapon::OnMaxChargeTimeReached, 5000.0f, false);
 
-	if (RecoilSound)
+	UCSCombatAudioSubsystem* CombatAudio = GetWorld()->GetSubsystem<UCSCombatAudioSubsystem>();
+	if (RecoilSound && CombatAudio)
 	{
-		UGameplayStatics::PlaySoundAtLocation(GetWorld(), RecoilSound, GetActorLocation());
+		CombatAudio->PlayCombatSound(RecoilSound, GetActorLocation(), CSCombatSoundCategory::WEAPON, Character);
+	}
+
+	//The server measures the charge of the shot on its own
+	UCSProjectileNetComponent* ProjectileNetComp = Character ? Character->GetProjectileNetComponent() : nullptr;
+	if (ProjectileNetComp && ProjectileNetComp->IsNetworked())
+	{
+		ProjectileNetComp->StartCharge();
 	}
 }
 
 void ACSRangedWeapon::Shoot()
 {
-	FActorSpawnParameters SpawnParams;
-	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-
-	FVector SpawnPosition = MeshComp->GetSocketLocation("ProjectileSocket");
+	FVector SpawnPosition = GetProjectileSpawnLocation();
 	FVector DestinationLocation = CalculateProjectileDestination();
-	FRotator LookAtRotation = UKismetMathLibrary::FindLookAtRotation(SpawnPosition, DestinationLocation);
 
-	ACSProjectile* Projectile = GetWorld()->SpawnActor<ACSProjectile>(DefaultProjectileClass, SpawnPosition, LookAtRotation, SpawnParams);
-	if (Projectile)
+	if (RangedWeaponDebugDraw > 0)
 	{
-		Projectile->SetOwner(GetOwner());
-		Projectile->SetDamageMultiplier(CalculateDamageMultiplier());
+		DrawDebugSphere(GetWorld(), SpawnPosition, 5.0f, 12, FColor::Green, false, 2.0f);
+		DrawDebugLine(GetWorld(), SpawnPosition, DestinationLocation, FColor::Red, false, 1.0f, 0u, 1.0f);
+		DrawDebugSphere(GetWorld(), DestinationLocation, 5.0f, 12, FColor::Red, false, 2.0f);
+	}
 
-		UBoxComponent* ProjectileCollisionComponent = Projectile->GetCollisionComponent();
-		if (ProjectileCollisionComponent)
-		{
-			if (RangedWeaponDebugDraw > 0)
-			{
-				DrawDebugSphere(GetWorld(), SpawnPosition, 5.0f, 12, FColor::Green, false, 2.0f);
-				DrawDebugLine(GetWorld(), SpawnPosition, DestinationLocation, FColor::Red, false, 1.0f, 0u, 1.0f);
+	PlayShootSound();
 
-				DrawDebugLine(GetWorld(), SpawnPosition, SpawnPosition + Projectile->GetActorForwardVector().GetSafeNormal() * 50.0f, FColor::Red, false, 2.5f, 0u, 1.0f);
-				DrawDebugSphere(GetWorld(), DestinationLocation, 5.0f, 12, FColor::Red, false, 2.0f);
-			}
+	FCSProjectileSpawnParams SpawnParams;
+	SpawnParams.Origin = SpawnPosition;
+	SpawnParams.Direction = (DestinationLocation - SpawnPosition).GetSafeNormal();
+	SpawnParams.SetCharge(GetWorldTimerManager().GetTimerElapsed(TimerHandle_ChargeTimer) / MaxChargeTime);
+	SpawnParams.Seed = (uint16)FMath::Rand();
 
+	//Networked games send the shot instead of only spawning the arrow here
+	UCSProjectileNetComponent* ProjectileNetComp = Character ? Character->GetProjectileNetComponent() : nullptr;
+	if (ProjectileNetComp && ProjectileNetComp->IsNetworked())
+	{
+		ProjectileNetComp->FireProjectile(SpawnParams);
+		return;
+	}
 
-			if (ShootSound) { UGameplayStatics::PlaySoundAtLocation(GetWorld(), ShootSound, GetActorLocation()); }
+	SpawnProjectile(SpawnParams, false);
+}
 
-			if (ProjectileCollisionComponent->IsSimulatingPhysics())
-			{
-				float ElapsedTime = GetWorldTimerManager().GetTimerElapsed(TimerHandle_ChargeTimer);
-				float ImpulsePercentage = FMath::Clamp(ElapsedTime / MaxChargeTime, 0.15f, 1.0f);
-				ProjectileCollisionComponent->AddImpulse(Projectile->GetActorForwardVector().GetSafeNormal() * MaxShootImpulse * ImpulsePercentage);
-			}
-		}
+void ACSRangedWeapon::PlayShootSound()
+{
+	UCSCombatAudioSubsystem* CombatAudio = GetWorld()->GetSubsystem<UCSCombatAudioSubsystem>();
+	if (ShootSound && CombatAudio) { CombatAudio->PlayCombatSound(ShootSound, GetActorLocation(), CSCombatSoundCategory::WEAPON, Character); }
+}
+
+float ACSRangedWeapon::GetMaxChargeTime() const
+{
+	return MaxChargeTime;
+}
+
+float ACSRangedWeapon::GetMinTimeBetweenShots() const
+{
+	return MinTimeBetweenShots;
+}
+
+ACSProjectile* ACSRangedWeapon::SpawnProjectile(const FCSProjectileSpawnParams& Params, bool Cosmetic)
+{
+	FVector SpawnPosition = Params.Origin;
+	FVector Direction = Params.Direction.GetSafeNormal();
+	if (SpreadAngle > 0.0f)
+	{
+		FRandomStream SpreadStream(Params.Seed);
+		Direction = SpreadStream.VRandCone(Direction, FMath::DegreesToRadians(SpreadAngle));
+	}
+
+	ACSProjectile* Projectile = nullptr;
+	UCSProjectilePoolSubsystem* ProjectilePool = GetWorld()->GetSubsystem<UCSProjectilePoolSubsystem>();
+	if (ProjectilePool)
+	{
+		Projectile = ProjectilePool->AcquireProjectile(DefaultProjectileClass, FTransform(Direction.Rotation(), SpawnPosition), GetOwner());
 	}
 	else
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		Projectile = GetWorld()->SpawnActor<ACSProjectile>(DefaultProjectileClass, SpawnPosition, Direction.Rotation(), SpawnParams);
+		if (Projectile) { Projectile->SetOwner(GetOwner()); }
+	}
+
+	if (Projectile == nullptr)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Trying to shoot a projectile returned null on object: %s"), *GetName())
+		return nullptr;
+	}
+
+	Projectile->SetNetId(Params.ProjectileId, Cosmetic);
+	Projectile->SetDamageMultiplier(CalculateDamageMultiplier(Params.GetCharge()));
+
+	UBoxComponent* ProjectileCollisionComponent = Projectile->GetCollisionComponent();
+	if (ProjectileCollisionComponent)
+	{
+		if (RangedWeaponDebugDraw > 0)
+		{
+			DrawDebugLine(GetWorld(), SpawnPosition, SpawnPosition + Projectile->GetActorForwardVector().GetSafeNormal() * 50.0f, FColor::Red, false, 2.5f, 0u, 1.0f);
+		}
+
+		if (ProjectileCollisionComponent->IsSimulatingPhysics())
+		{
+			float ImpulsePercentage = FMath::Clamp(Params.GetCharge(), 0.15f, 1.0f);
+			Projectile->Launch(Projectile->GetActorForwardVector().GetSafeNormal() * MaxShootImpulse * ImpulsePercentage, UCSProjectileSimulationSubsystem::IsSimulationEnabled());
+		}
 	}
+
+	return Projectile;
 }
 
-float ACSRangedWeapon::CalculateDamageMultiplier()
+TSubclassOf<ACSProjectile> ACSRangedWeapon::GetProjectileClass() const
 {
-	float ElapsedTime = GetWorldTimerManager().GetTimerElapsed(TimerHandle_ChargeTimer);
-	return FMath::Clamp(ElapsedTime / MaxChargeTime, 0.5f, 1.5f);
+	return DefaultProjectileClass;
+}
+
+FVector ACSRangedWeapon::GetProjectileSpawnLocation() const
+{
+	return MeshComp->GetSocketLocation("ProjectileSocket");
+}
+
+float ACSRangedWeapon::CalculateDamageMultiplier(float Charge) const
+{
+	return FMath::Clamp(Charge, 0.5f, 1.5f);
 }
 
 void ACSRangedWeapon::OnMaxChargeTimeReached()
@@ -97,35 +194,89 @@ void ACSRangedWeapon::OnMaxChargeTimeReached()
 
 FVector ACSRangedWeapon::CalculateProjectileDestination()
 {
-	FVector Destination;
 	if (Character->IsTargetLocked())
 	{
 		return Character->GetLockedTarget()->GetActorLocation() + FVector(0.0f, 0.0f, 50.0f);
 	}
-	else
+
+	FVector ViewLocation = Character->GetPawnViewLocation();
+	FVector ViewDirection = Character->GetViewRotation().Vector();
+
+	//Characters near the crosshair are resolved without tracing the whole range
+	ACSCharacter* AimTarget = FindAimAssistTarget(ViewLocation, ViewDirection);
+	if (AimTarget)
+	{
+		FVector TargetLocation = AimTarget->GetActorLocation();
+		FVector CrosshairLocation = ViewLocation + ViewDirection * FVector::DotProduct(TargetLocation - ViewLocation, ViewDirection);
+		FVector Destination = FMath::Lerp(CrosshairLocation, TargetLocation, FMath::Clamp(AimAssistStrength, 0.0f, 1.0f));
+
+		if (RangedWeaponDebugDraw > 0)
+		{
+			DrawDebugLine(GetWorld(), ViewLocation, Destination, FColor::Yellow, false, 2.0f, 0u, 1.0f);
+		}
+
+		return Destination;
+	}
+
+	FVector TraceEnd = ViewLocation + ViewDirection * WeaponRange;
+
+	FCollisionQueryParams QueryParams;
+	QueryParams.AddIgnoredActor(this);
+	QueryParams.AddIgnoredActor(GetOwner());
+
+	FHitResult HitResult;
+	//If a hit point is found, send the arrow there, otherwise send it to the max arrow range
+	if (GetWorld()->LineTraceSingleByChannel(HitResult, ViewLocation, TraceEnd, COLLISION_WEAPON, QueryParams))
 	{
-		FVector TraceStart = Character->GetPawnViewLocation();
-		FVector TraceEnd = Character->GetPawnViewLocation() + (Character->GetViewRotation().Vector() * 100000000.0f);
+		return HitResult.Location;
+	}
 
-		FCollisionQueryParams QueryParams;
-		QueryParams.AddIgnoredActor(this);
-		QueryParams.bTraceComplex = true;
+	return TraceEnd;
+}
 
+ACSCharacter* ACSRangedWeapon::FindAimAssistTarget(const FVector& ViewLocation, const FVector& ViewDirection) const
+{
+	UCSCharacterRegistry* CharacterRegistry = GetWorld()->GetSubsystem<UCSCharacterRegistry>();
+	if (CharacterRegistry == nullptr) { return nullptr; }
 
-		FHitResult HitResult;
-		//If a hit point is found, send the arrow there
-		if (GetWorld()->LineTraceSingleByChannel(HitResult, TraceStart, TraceEnd, COLLISION_WEAPON, QueryParams))
+	float MinimumDot = FMath::Cos(FMath::DegreesToRadians(AimAssistConeAngle));
+	float MaxDistanceSquared = WeaponRange * WeaponRange;
+
+	//Pick the character closest to the crosshair
+	ACSCharacter* BestTarget = nullptr;
+	float BestDot = MinimumDot;
+	for (ACSCharacter* OtherCharacter : CharacterRegistry->GetCharacters())
+	{
+		if (OtherCharacter == nullptr || OtherCharacter == Character || OtherCharacter->GetCurrentState() == CharacterStateType::DEAD) { continue; }
+
+		FVector VectorToTarget = OtherCharacter->GetActorLocation() - ViewLocation;
+		float DistanceSquared = VectorToTarget.SizeSquared();
+		if (DistanceSquared > MaxDistanceSquared || DistanceSquared < KINDA_SMALL_NUMBER) { continue; }
+
+		float Dot = FVector::DotProduct(VectorToTarget * FMath::InvSqrt(DistanceSquared), ViewDirection);
+		if (Dot >= BestDot)
 		{
-			Destination = HitResult.Location;
-			//DrawDebugLine(GetWorld(), TraceStart, Destination, FColor::Green, false, 2.0f, 0u, 2.0f);
+			BestDot = Dot;
+			BestTarget = OtherCharacter;
 		}
-		//Send the arrow to the max arrow range
-		else
+	}
+
+	if (BestTarget == nullptr) { return nullptr; }
+
+	//Only the chosen target is checked for obstacles, against simple collision
+	FCollisionQueryParams QueryParams;
+	QueryParams.AddIgnoredActor(this);
+	QueryParams.AddIgnoredActor(GetOwner());
+
+	FHitResult HitResult;
+	if (GetWorld()->LineTraceSingleByChannel(HitResult, ViewLocation, BestTarget->GetActorLocation(), COLLISION_WEAPON, QueryParams))
+	{
+		AActor* HitActor = HitResult.GetActor();
+		if (HitActor != BestTarget && (HitActor == nullptr || HitActor->GetOwner() != BestTarget))
 		{
-			Destination = Character->GetPawnViewLocation() + (Character->GetViewRotation().Vector() * WeaponRange);
-			//DrawDebugLine(GetWorld(), TraceStart, Destination, FColor::Red, false, 2.0f, 0u, 2.0f);
+			return nullptr;
 		}
 	}
 
-	return Destination;
+	return BestTarget;
 }
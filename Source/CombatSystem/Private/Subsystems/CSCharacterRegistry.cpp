@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/CSCharacterRegistry.h"
+
+#include "CSCharacter.h"
+
+void UCSCharacterRegistry::RegisterCharacter(ACSCharacter* Character)
+{
+	if (Character == nullptr) { return; }
+
+	Characters.AddUnique(Character);
+}
+
+void UCSCharacterRegistry::UnregisterCharacter(ACSCharacter* Character)
+{
+	Characters.RemoveSwap(Character);
+}
+
+const TArray<ACSCharacter*>& UCSCharacterRegistry::GetCharacters() const
+{
+	return Characters;
+}
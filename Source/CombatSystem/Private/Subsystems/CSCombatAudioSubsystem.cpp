@@ -0,0 +1,180 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/CSCombatAudioSubsystem.h"
+
+#include "GameFramework/PlayerController.h"
+#include "Kismet/GameplayStatics.h"
+#include "Sound/SoundBase.h"
+#include "Sound/SoundAttenuation.h"
+#include "../../CombatSystem.h"
+
+static int32 MaxImpactVoices = 6;
+FAutoConsoleVariableRef CVARMaxImpactVoices(
+	TEXT("CS.MaxImpactVoices"),
+	MaxImpactVoices,
+	TEXT("Maximum number of impact sounds playing at the same time"),
+	ECVF_Cheat);
+
+static int32 MaxSwingVoices = 4;
+FAutoConsoleVariableRef CVARMaxSwingVoices(
+	TEXT("CS.MaxSwingVoices"),
+	MaxSwingVoices,
+	TEXT("Maximum number of weapon swing sounds playing at the same time"),
+	ECVF_Cheat);
+
+static int32 MaxHitReactionVoices = 3;
+FAutoConsoleVariableRef CVARMaxHitReactionVoices(
+	TEXT("CS.MaxHitReactionVoices"),
+	MaxHitReactionVoices,
+	TEXT("Maximum number of hit reaction sounds playing at the same time"),
+	ECVF_Cheat);
+
+static int32 MaxWeaponVoices = 4;
+FAutoConsoleVariableRef CVARMaxWeaponVoices(
+	TEXT("CS.MaxWeaponVoices"),
+	MaxWeaponVoices,
+	TEXT("Maximum number of bow sounds playing at the same time"),
+	ECVF_Cheat);
+
+static int32 PlayerReservedVoices = 2;
+FAutoConsoleVariableRef CVARPlayerReservedVoices(
+	TEXT("CS.PlayerReservedVoices"),
+	PlayerReservedVoices,
+	TEXT("Voices over the category limit that only sounds involving a local player can use"),
+	ECVF_Cheat);
+
+static float CombatSoundMergeWindow = 0.08f;
+FAutoConsoleVariableRef CVARCombatSoundMergeWindow(
+	TEXT("CS.CombatSoundMergeWindow"),
+	CombatSoundMergeWindow,
+	TEXT("The same sound started again within this time and CS.CombatSoundMergeDistance is dropped"),
+	ECVF_Cheat);
+
+static float CombatSoundMergeDistance = 200.0f;
+FAutoConsoleVariableRef CVARCombatSoundMergeDistance(
+	TEXT("CS.CombatSoundMergeDistance"),
+	CombatSoundMergeDistance,
+	TEXT("The same sound started again within this distance and CS.CombatSoundMergeWindow is dropped"),
+	ECVF_Cheat);
+
+static float CombatAudioCullDistance = 5000.0f;
+FAutoConsoleVariableRef CVARCombatAudioCullDistance(
+	TEXT("CS.CombatAudioCullDistance"),
+	CombatAudioCullDistance,
+	TEXT("Combat sounds further than this from every listener are not played, sounds with a shorter attenuation use their own"),
+	ECVF_Cheat);
+
+//Voices are released after this time even if the sound is longer or loops
+static const float MaxVoiceDuration = 5.0f;
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Combat Sounds Played"), STAT_CSCombatSoundsPlayed, STATGROUP_CombatSystem);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Combat Sounds Culled"), STAT_CSCombatSoundsCulled, STATGROUP_CombatSystem);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Combat Sounds Merged"), STAT_CSCombatSoundsMerged, STATGROUP_CombatSystem);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Combat Sounds Over Budget"), STAT_CSCombatSoundsOverBudget, STATGROUP_CombatSystem);
+
+static int32 GetMaxVoices(CSCombatSoundCategory Category)
+{
+	switch (Category)
+	{
+	case CSCombatSoundCategory::IMPACT:
+		return MaxImpactVoices;
+	case CSCombatSoundCategory::SWING:
+		return MaxSwingVoices;
+	case CSCombatSoundCategory::HIT_REACTION:
+		return MaxHitReactionVoices;
+	case CSCombatSoundCategory::WEAPON:
+		return MaxWeaponVoices;
+	default:
+		return 0;
+	}
+}
+
+bool UCSCombatAudioSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	//Not created at all in server builds
+	return CS_WITH_COSMETICS && (WorldType == EWorldType::Game || WorldType == EWorldType::PIE);
+}
+
+bool UCSCombatAudioSubsystem::IsPlayerInvolved(const AActor* Actor) const
+{
+	//Weapons and projectiles are owned by the character using them
+	const APawn* Pawn = Cast<APawn>(Actor);
+	if (Pawn == nullptr && Actor) { Pawn = Cast<APawn>(Actor->GetOwner()); }
+
+	return Pawn && Pawn->IsPlayerControlled() && Pawn->IsLocallyControlled();
+}
+
+bool UCSCombatAudioSubsystem::IsAudibleByAnyListener(const USoundBase* Sound, const FVector& Location) const
+{
+	//2D and UI sounds are heard the same from anywhere
+	const FSoundAttenuationSettings* AttenuationSettings = Sound->GetAttenuationSettingsToApply();
+	if (AttenuationSettings == nullptr || !AttenuationSettings->bAttenuate) { return true; }
+
+	float MaxDistance = FMath::Min(Sound->GetMaxDistance(), CombatAudioCullDistance);
+	float MaxDistanceSquared = MaxDistance * MaxDistance;
+
+	for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		APlayerController* PlayerController = Iterator->Get();
+		if (PlayerController == nullptr || !PlayerController->IsLocalController()) { continue; }
+
+		FVector ListenerLocation;
+		FVector ListenerFront;
+		FVector ListenerRight;
+		PlayerController->GetAudioListenerPosition(ListenerLocation, ListenerFront, ListenerRight);
+
+		if (FVector::DistSquared(ListenerLocation, Location) <= MaxDistanceSquared) { return true; }
+	}
+
+	return false;
+}
+
+bool UCSCombatAudioSubsystem::PlayCombatSound(USoundBase* Sound, const FVector& Location, CSCombatSoundCategory Category, const AActor* Instigator, const AActor* Other)
+{
+	//Dedicated servers have nobody to play sounds to
+	if (Sound == nullptr || Category >= CSCombatSoundCategory::MAX || !CSAreCosmeticsEnabled(GetWorld())) { return false; }
+
+	if (!IsAudibleByAnyListener(Sound, Location))
+	{
+		INC_DWORD_STAT(STAT_CSCombatSoundsCulled);
+		return false;
+	}
+
+	//Sounds are not slowed down by the hit pauses
+	float Time = GetWorld()->GetAudioTimeSeconds();
+	TArray<FCSCombatVoice>& CategoryVoices = Voices[(uint8)Category];
+	CategoryVoices.RemoveAllSwap([Time](const FCSCombatVoice& Voice) { return Voice.EndTime <= Time; }, false);
+
+	//Several hits of the same sound on the same spot are heard as one
+	float MergeDistanceSquared = CombatSoundMergeDistance * CombatSoundMergeDistance;
+	for (const FCSCombatVoice& Voice : CategoryVoices)
+	{
+		if (Voice.Sound == Sound && Time - Voice.StartTime <= CombatSoundMergeWindow && FVector::DistSquared(Voice.Location, Location) <= MergeDistanceSquared)
+		{
+			INC_DWORD_STAT(STAT_CSCombatSoundsMerged);
+			return false;
+		}
+	}
+
+	int32 MaxVoices = GetMaxVoices(Category);
+	if (IsPlayerInvolved(Instigator) || IsPlayerInvolved(Other))
+	{
+		MaxVoices += PlayerReservedVoices;
+	}
+
+	if (CategoryVoices.Num() >= MaxVoices)
+	{
+		INC_DWORD_STAT(STAT_CSCombatSoundsOverBudget);
+		return false;
+	}
+
+	FCSCombatVoice& Voice = CategoryVoices.AddDefaulted_GetRef();
+	Voice.Sound = Sound;
+	Voice.Location = Location;
+	Voice.StartTime = Time;
+	Voice.EndTime = Time + FMath::Clamp(Sound->GetDuration(), KINDA_SMALL_NUMBER, MaxVoiceDuration);
+
+	INC_DWORD_STAT(STAT_CSCombatSoundsPlayed);
+	UGameplayStatics::PlaySoundAtLocation(GetWorld(), Sound, Location);
+	return true;
+}
@@ -0,0 +1,212 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/CSEnemyPoolSubsystem.h"
+
+#include "CSCharacter.h"
+#include "GameFramework/Controller.h"
+#include "TimerManager.h"
+#include "../../CombatSystem.h"
+
+static float EnemySpawnBudgetMs = 2.0f;
+FAutoConsoleVariableRef CVAREnemySpawnBudgetMs(
+	TEXT("CS.EnemySpawnBudgetMs"),
+	EnemySpawnBudgetMs,
+	TEXT("Milliseconds per frame spent spawning the enemies of a prewarm, at least one enemy is spawned each frame"),
+	ECVF_Cheat);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active Enemies"), STAT_CSActiveEnemies, STATGROUP_CombatSystem);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled Enemies"), STAT_CSPooledEnemies, STATGROUP_CombatSystem);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemy High Water Mark"), STAT_CSEnemyHighWaterMark, STATGROUP_CombatSystem);
+
+void UCSEnemyPoolSubsystem::Deinitialize()
+{
+	GetWorld()->GetTimerManager().ClearTimer(TimerHandle_Prewarm);
+
+	for (const TPair<TSubclassOf<ACSCharacter>, FCSEnemyPool>& Pool : Pools)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Enemy pool %s: %d enemies, high water mark %d"), *GetNameSafe(Pool.Key), Pool.Value.FreeEnemies.Num() + Pool.Value.ActiveEnemies.Num(), Pool.Value.HighWaterMark);
+
+		DEC_DWORD_STAT_BY(STAT_CSActiveEnemies, Pool.Value.ActiveEnemies.Num());
+		DEC_DWORD_STAT_BY(STAT_CSPooledEnemies, Pool.Value.FreeEnemies.Num() + Pool.Value.ActiveEnemies.Num());
+	}
+
+	Pools.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCSEnemyPoolSubsystem::PrewarmPool(TSubclassOf<ACSCharacter> EnemyClass, int32 Count)
+{
+	if (EnemyClass == nullptr) { return; }
+
+	FCSEnemyPool& Pool = Pools.FindOrAdd(EnemyClass);
+	RemoveInvalidEnemies(Pool);
+
+	Pool.PendingPrewarm = FMath::Max(Count - Pool.FreeEnemies.Num() - Pool.ActiveEnemies.Num(), 0);
+
+	if (Pool.PendingPrewarm > 0 && !TimerHandle_Prewarm.IsValid())
+	{
+		TimerHandle_Prewarm = GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UCSEnemyPoolSubsystem::PrewarmNextEnemies);
+	}
+}
+
+bool UCSEnemyPoolSubsystem::IsPrewarming() const
+{
+	for (const TPair<TSubclassOf<ACSCharacter>, FCSEnemyPool>& Pool : Pools)
+	{
+		if (Pool.Value.PendingPrewarm > 0) { return true; }
+	}
+
+	return false;
+}
+
+void UCSEnemyPoolSubsystem::PrewarmNextEnemies()
+{
+	TimerHandle_Prewarm.Invalidate();
+
+	//The first spawn of the frame is always allowed so a prewarm ends even when a single enemy is over the budget
+	double BudgetEndTime = FPlatformTime::Seconds() + EnemySpawnBudgetMs / 1000.0;
+	bool FirstSpawn = true;
+
+	for (TPair<TSubclassOf<ACSCharacter>, FCSEnemyPool>& Pool : Pools)
+	{
+		while (Pool.Value.PendingPrewarm > 0 && (FirstSpawn || FPlatformTime::Seconds() < BudgetEndTime))
+		{
+			FirstSpawn = false;
+
+			ACSCharacter* Enemy = SpawnPooledEnemy(Pool.Key);
+			if (Enemy == nullptr)
+			{
+				Pool.Value.PendingPrewarm = 0;
+				break;
+			}
+
+			//Prewarmed enemies get their controller the first time they are used
+			FCSPooledEnemy PooledEnemy;
+			PooledEnemy.Enemy = Enemy;
+
+			Pool.Value.PendingPrewarm--;
+			Pool.Value.FreeEnemies.Add(PooledEnemy);
+		}
+	}
+
+	if (IsPrewarming())
+	{
+		TimerHandle_Prewarm = GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UCSEnemyPoolSubsystem::PrewarmNextEnemies);
+	}
+}
+
+ACSCharacter* UCSEnemyPoolSubsystem::AcquireEnemy(TSubclassOf<ACSCharacter> EnemyClass, const FTransform& SpawnTransform)
+{
+	if (EnemyClass == nullptr) { return nullptr; }
+
+	FCSEnemyPool& Pool = Pools.FindOrAdd(EnemyClass);
+	RemoveInvalidEnemies(Pool);
+
+	FCSPooledEnemy PooledEnemy;
+	if (Pool.FreeEnemies.Num() > 0)
+	{
+		PooledEnemy = Pool.FreeEnemies.Pop(false);
+	}
+	else
+	{
+		//The prewarm didn't reach this one yet
+		PooledEnemy.Enemy = SpawnPooledEnemy(EnemyClass);
+		Pool.PendingPrewarm = FMath::Max(Pool.PendingPrewarm - 1, 0);
+	}
+
+	ACSCharacter* Enemy = PooledEnemy.Enemy;
+	if (Enemy == nullptr) { return nullptr; }
+
+	Pool.ActiveEnemies.Add(Enemy);
+	INC_DWORD_STAT(STAT_CSActiveEnemies);
+
+	if (Pool.ActiveEnemies.Num() > Pool.HighWaterMark)
+	{
+		Pool.HighWaterMark = Pool.ActiveEnemies.Num();
+		SET_DWORD_STAT(STAT_CSEnemyHighWaterMark, Pool.HighWaterMark);
+	}
+
+	Enemy->ResetCharacter(SpawnTransform);
+
+	if (IsValid(PooledEnemy.Controller))
+	{
+		PooledEnemy.Controller->Possess(Enemy);
+	}
+	else if (Enemy->GetController() == nullptr)
+	{
+		Enemy->SpawnDefaultController();
+	}
+
+	return Enemy;
+}
+
+void UCSEnemyPoolSubsystem::ReleaseEnemy(ACSCharacter* Enemy)
+{
+	if (Enemy == nullptr) { return; }
+
+	FCSEnemyPool* Pool = Pools.Find(Enemy->GetClass());
+	if (Pool == nullptr || Pool->ActiveEnemies.Remove(Enemy) == 0)
+	{
+		//Not pooled, such as enemies placed in the level
+		Enemy->StartDestroy();
+		return;
+	}
+
+	DEC_DWORD_STAT(STAT_CSActiveEnemies);
+
+	Enemy->PlayDestroyEffect();
+	Pool->FreeEnemies.Add(DeactivateEnemy(Enemy));
+}
+
+int32 UCSEnemyPoolSubsystem::GetHighWaterMark(TSubclassOf<ACSCharacter> EnemyClass) const
+{
+	const FCSEnemyPool* Pool = Pools.Find(EnemyClass);
+	return Pool ? Pool->HighWaterMark : 0;
+}
+
+ACSCharacter* UCSEnemyPoolSubsystem::SpawnPooledEnemy(TSubclassOf<ACSCharacter> EnemyClass)
+{
+	//Deferred so the enemy is never seen, hit or possessed at the origin before it is taken out of play
+	ACSCharacter* Enemy = GetWorld()->SpawnActorDeferred<ACSCharacter>(EnemyClass, FTransform::Identity, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	if (Enemy == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Could not spawn a pooled enemy of class %s"), *GetNameSafe(EnemyClass));
+		return nullptr;
+	}
+
+	Enemy->AutoPossessAI = EAutoPossessAI::Disabled;
+	Enemy->SetActorHiddenInGame(true);
+	Enemy->SetActorEnableCollision(false);
+	Enemy->FinishSpawning(FTransform::Identity);
+
+	//Equipment is only spawned by BeginPlay, it is hidden with the rest of the character
+	Enemy->DeactivateCharacter();
+
+	INC_DWORD_STAT(STAT_CSPooledEnemies);
+
+	return Enemy;
+}
+
+FCSPooledEnemy UCSEnemyPoolSubsystem::DeactivateEnemy(ACSCharacter* Enemy)
+{
+	FCSPooledEnemy PooledEnemy;
+	PooledEnemy.Enemy = Enemy;
+	PooledEnemy.Controller = Enemy->GetController();
+
+	//The controller stops its logic while it has no pawn
+	if (PooledEnemy.Controller) { PooledEnemy.Controller->UnPossess(); }
+
+	Enemy->DeactivateCharacter();
+
+	return PooledEnemy;
+}
+
+void UCSEnemyPoolSubsystem::RemoveInvalidEnemies(FCSEnemyPool& Pool)
+{
+	//Enemies destroyed by someone else, such as a level unload, are dropped from the pool
+	int32 RemovedFreeEnemies = Pool.FreeEnemies.RemoveAllSwap([](const FCSPooledEnemy& PooledEnemy) { return !IsValid(PooledEnemy.Enemy); });
+	int32 RemovedActiveEnemies = Pool.ActiveEnemies.RemoveAllSwap([](ACSCharacter* Enemy) { return !IsValid(Enemy); });
+	DEC_DWORD_STAT_BY(STAT_CSActiveEnemies, RemovedActiveEnemies);
+	DEC_DWORD_STAT_BY(STAT_CSPooledEnemies, RemovedFreeEnemies + RemovedActiveEnemies);
+}
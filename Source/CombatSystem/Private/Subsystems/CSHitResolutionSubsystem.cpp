@@ -0,0 +1,183 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/CSHitResolutionSubsystem.h"
+
+#include "CSCharacter.h"
+#include "Components/CSHealthComponent.h"
+#include "Actions/CSCharacterState_Attack.h"
+#include "Subsystems/CSImpactEffectSubsystem.h"
+#include "Subsystems/CSCombatAudioSubsystem.h"
+
+#include "Kismet/GameplayStatics.h"
+#include "../../CombatSystem.h"
+
+void FCSHitResolutionTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Subsystem)
+	{
+		Subsystem->ResolveHits();
+	}
+}
+
+FString FCSHitResolutionTickFunction::DiagnosticMessage()
+{
+	return TEXT("FCSHitResolutionTickFunction");
+}
+
+bool UCSHitResolutionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCSHitResolutionSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	NextSequence = 0u;
+
+	//Runs after physics, the melee sweeps and the timers so every hit of the frame is already recorded
+	ResolutionTickFunction.Subsystem = this;
+	ResolutionTickFunction.bCanEverTick = true;
+	ResolutionTickFunction.bStartWithTickEnabled = true;
+	ResolutionTickFunction.TickGroup = TG_PostUpdateWork;
+	ResolutionTickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void UCSHitResolutionSubsystem::Deinitialize()
+{
+	if (ResolutionTickFunction.IsTickFunctionRegistered())
+	{
+		ResolutionTickFunction.UnRegisterTickFunction();
+	}
+
+	PendingHits.Empty();
+	ResolvingHits.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCSHitResolutionSubsystem::AddHit(FCSHitRecord&& HitRecord)
+{
+	AActor* DamageCauser = HitRecord.DamageEvent.DamageCauser.Get();
+	HitRecord.DamageCauserID = DamageCauser ? DamageCauser->GetUniqueID() : 0u;
+
+	//Resolvers only get the causer as it was now, it can be released to its pool before the end of the frame
+	if (DamageCauser) { HitRecord.DamageEvent.DamageCauserLocation = DamageCauser->GetActorLocation(); }
+	else if (HitRecord.DamageEvent.bHasImpactPoint) { HitRecord.DamageEvent.DamageCauserLocation = HitRecord.DamageEvent.ImpactPoint; }
+	HitRecord.Sequence = NextSequence++;
+	PendingHits.Add(MoveTemp(HitRecord));
+}
+
+void UCSHitResolutionSubsystem::ResolveHits()
+{
+	if (PendingHits.Num() == 0) { return; }
+
+	//Hits recorded while resolving are left for the next frame
+	Swap(PendingHits, ResolvingHits);
+
+	//Deterministic order: by attacker, then victim, then detection order
+	ResolvingHits.Sort([](const FCSHitRecord& A, const FCSHitRecord& B)
+	{
+		uint32 AttackerA = A.DamageEvent.Attacker.IsValid() ? A.DamageEvent.Attacker->GetUniqueID() : 0u;
+		uint32 AttackerB = B.DamageEvent.Attacker.IsValid() ? B.DamageEvent.Attacker->GetUniqueID() : 0u;
+		if (AttackerA != AttackerB) { return AttackerA < AttackerB; }
+
+		uint32 VictimA = A.Victim.IsValid() ? A.Victim->GetUniqueID() : 0u;
+		uint32 VictimB = B.Victim.IsValid() ? B.Victim->GetUniqueID() : 0u;
+		if (VictimA != VictimB) { return VictimA < VictimB; }
+
+		return A.Sequence < B.Sequence;
+	});
+
+	//The same weapon or projectile only hits the same victim once per frame
+	for (int32 i = ResolvingHits.Num() - 1; i > 0; --i)
+	{
+		const FCSHitRecord& Hit = ResolvingHits[i];
+		const FCSHitRecord& PreviousHit = ResolvingHits[i - 1];
+		if (Hit.Victim == PreviousHit.Victim && Hit.DamageCauserID == PreviousHit.DamageCauserID && Hit.DamageCauserID != 0u)
+		{
+			ResolvingHits.RemoveAt(i, 1, false);
+		}
+	}
+
+	ResolveDamage();
+	NotifyAttackers();
+
+#if CS_WITH_COSMETICS
+	if (CSAreCosmeticsEnabled(GetWorld())) { PlayImpactCosmetics(); }
+#endif
+
+	ResolvingHits.Reset();
+}
+
+void UCSHitResolutionSubsystem::ResolveDamage()
+{
+	for (const FCSHitRecord& Hit : ResolvingHits)
+	{
+		AActor* Victim = Hit.Victim.Get();
+		if (!Hit.bDealsDamage || Victim == nullptr) { continue; }
+
+		ACSCharacter* VictimCharacter = Cast<ACSCharacter>(Victim);
+		if (VictimCharacter)
+		{
+			VictimCharacter->GetHealthComponent()->ApplyCombatDamage(Hit.DamageEvent);
+		}
+		else
+		{
+			AActor* DamageCauser = Hit.DamageEvent.DamageCauser.Get();
+			ACSCharacter* Attacker = Hit.DamageEvent.Attacker.Get();
+			UGameplayStatics::ApplyDamage(Victim, Hit.DamageEvent.GetDamage(), Attacker ? Attacker->GetController() : nullptr, DamageCauser, Hit.DamageEvent.DamageType);
+		}
+	}
+}
+
+void UCSHitResolutionSubsystem::NotifyAttackers()
+{
+	//Hits are sorted by attacker so each one plays its strike feedback once even when hitting several enemies
+	ACSCharacter* LastNotifiedAttacker = nullptr;
+	for (const FCSHitRecord& Hit : ResolvingHits)
+	{
+		ACSCharacter* Attacker = Hit.DamageEvent.Attacker.Get();
+		if (!Hit.bNotifyAttacker || Attacker == nullptr || Attacker == LastNotifiedAttacker) { continue; }
+
+		UCSCharacterState_Attack* AttackState = Cast<UCSCharacterState_Attack>(Attacker->GetCharacterState(CharacterStateType::ATTACK));
+		if (AttackState)
+		{
+			AttackState->OnEnemyHit();
+		}
+
+		LastNotifiedAttacker = Attacker;
+	}
+}
+
+void UCSHitResolutionSubsystem::PlayImpactCosmetics()
+{
+	UCSImpactEffectSubsystem* ImpactEffects = GetWorld()->GetSubsystem<UCSImpactEffectSubsystem>();
+	UCSCombatAudioSubsystem* CombatAudio = GetWorld()->GetSubsystem<UCSCombatAudioSubsystem>();
+
+	//Effects and sounds are budgeted where they are spawned, by CS.MaxImpactEffectsPerFrame and the voices of each sound category
+	for (const FCSHitRecord& Hit : ResolvingHits)
+	{
+		UNiagaraSystem* ImpactEffect = Hit.ImpactEffect.Get();
+		USoundBase* ImpactSound = Hit.ImpactSound.Get();
+
+		//Exchanges nobody sees are skipped, far ones only keep their impact effect
+		ACSCharacter* Attacker = Hit.DamageEvent.Attacker.Get();
+		CSCosmeticDetail Detail = Attacker ? Attacker->GetCosmeticDetail(Hit.Victim.Get()) : CSCosmeticDetail::FULL;
+		if (Detail == CSCosmeticDetail::NONE) { continue; }
+		if (Detail == CSCosmeticDetail::REDUCED) { ImpactSound = nullptr; }
+
+		if (ImpactEffect == nullptr && ImpactSound == nullptr) { continue; }
+
+		if (ImpactEffect && ImpactEffects)
+		{
+			FRotator ImpactRotation = Hit.DamageEvent.ImpactNormal.IsNearlyZero() ? FRotator::ZeroRotator : Hit.DamageEvent.ImpactNormal.Rotation();
+			ImpactEffects->SpawnImpactEffect(ImpactEffect, Hit.DamageEvent.ImpactPoint, ImpactRotation);
+		}
+
+		if (ImpactSound && CombatAudio)
+		{
+			CombatAudio->PlayCombatSound(ImpactSound, Hit.DamageEvent.ImpactPoint, CSCombatSoundCategory::IMPACT, Attacker, Hit.Victim.Get());
+		}
+	}
+}
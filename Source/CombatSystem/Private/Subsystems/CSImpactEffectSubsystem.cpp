@@ -0,0 +1,210 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/CSImpactEffectSubsystem.h"
+
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+#include "NiagaraFunctionLibrary.h"
+#include "NiagaraComponent.h"
+#include "TimerManager.h"
+#include "../../CombatSystem.h"
+
+static int32 MaxImpactEffectsPerFrame = 6;
+FAutoConsoleVariableRef CVARMaxImpactEffectsPerFrame(
+	TEXT("CS.MaxImpactEffectsPerFrame"),
+	MaxImpactEffectsPerFrame,
+	TEXT("Maximum number of combat effects spawned in a single frame"),
+	ECVF_Cheat);
+
+static int32 MaxImpactEffectsPerSystem = 2;
+FAutoConsoleVariableRef CVARMaxImpactEffectsPerSystem(
+	TEXT("CS.MaxImpactEffectsPerSystem"),
+	MaxImpactEffectsPerSystem,
+	TEXT("Maximum number of instances of the same combat effect spawned in a single frame, essential effects such as character destroy effects are not limited"),
+	ECVF_Cheat);
+
+static float ImpactEffectCullDistance = 5000.0f;
+FAutoConsoleVariableRef CVARImpactEffectCullDistance(
+	TEXT("CS.ImpactEffectCullDistance"),
+	ImpactEffectCullDistance,
+	TEXT("Combat effects further than this from every local view are not spawned"),
+	ECVF_Cheat);
+
+static float ImpactEffectViewMargin = 15.0f;
+FAutoConsoleVariableRef CVARImpactEffectViewMargin(
+	TEXT("CS.ImpactEffectViewMargin"),
+	ImpactEffectViewMargin,
+	TEXT("Degrees added to half the field of view before a combat effect is considered out of view"),
+	ECVF_Cheat);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Impact Effects Spawned"), STAT_CSImpactEffectsSpawned, STATGROUP_CombatSystem);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Impact Effects Culled"), STAT_CSImpactEffectsCulled, STATGROUP_CombatSystem);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Impact Effects Over Budget"), STAT_CSImpactEffectsOverBudget, STATGROUP_CombatSystem);
+
+bool FCSImpactEffectTable::Find(EPhysicalSurface SurfaceType, uint8 AttackSubstate, UNiagaraSystem*& OutEffect, USoundBase*& OutSound) const
+{
+	const FCSImpactEffectEntry* AnySubstateEntry = nullptr;
+	for (const FCSImpactEffectEntry& Entry : Entries)
+	{
+		if (Entry.SurfaceType != SurfaceType) { continue; }
+
+		if (!Entry.AnySubstate && Entry.AttackSubstate == AttackSubstate)
+		{
+			OutEffect = Entry.Effect;
+			OutSound = Entry.Sound;
+			return true;
+		}
+
+		if (Entry.AnySubstate && AnySubstateEntry == nullptr)
+		{
+			AnySubstateEntry = &Entry;
+		}
+	}
+
+	if (AnySubstateEntry == nullptr) { return false; }
+
+	OutEffect = AnySubstateEntry->Effect;
+	OutSound = AnySubstateEntry->Sound;
+	return true;
+}
+
+bool UCSImpactEffectSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	//Not created at all in server builds
+	return CS_WITH_COSMETICS && (WorldType == EWorldType::Game || WorldType == EWorldType::PIE);
+}
+
+bool UCSImpactEffectSubsystem::IsVisibleFromAnyView(const FVector& Location) const
+{
+	float CullDistanceSquared = ImpactEffectCullDistance * ImpactEffectCullDistance;
+
+	for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		APlayerController* PlayerController = Iterator->Get();
+		if (PlayerController == nullptr || !PlayerController->IsLocalController() || PlayerController->PlayerCameraManager == nullptr) { continue; }
+
+		FVector ViewLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+		FVector ToLocation = Location - ViewLocation;
+		float DistanceSquared = ToLocation.SizeSquared();
+		if (DistanceSquared > CullDistanceSquared) { continue; }
+
+		//Effects right next to the camera can fill the screen even when their origin is off view
+		float NearDistance = ImpactEffectCullDistance * 0.1f;
+		if (DistanceSquared < NearDistance * NearDistance) { return true; }
+
+		FVector ViewDirection = PlayerController->PlayerCameraManager->GetCameraRotation().Vector();
+		float MaxViewAngle = FMath::Min(PlayerController->PlayerCameraManager->GetFOVAngle() * 0.5f + ImpactEffectViewMargin, 180.0f);
+		if (FVector::DotProduct(ViewDirection, ToLocation * FMath::InvSqrt(DistanceSquared)) >= FMath::Cos(FMath::DegreesToRadians(MaxViewAngle)))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+UNiagaraComponent* UCSImpactEffectSubsystem::SpawnImpactEffect(UNiagaraSystem* Effect, const FVector& Location, const FRotator& Rotation)
+{
+	//Dedicated servers have nobody to show effects to
+	if (Effect == nullptr || !CSAreCosmeticsEnabled(GetWorld())) { return nullptr; }
+
+	UpdateBudgetFrame();
+
+	if (!IsVisibleFromAnyView(Location))
+	{
+		INC_DWORD_STAT(STAT_CSImpactEffectsCulled);
+		return nullptr;
+	}
+
+	int32& SystemSpawns = FrameSystemSpawns.FindOrAdd(Effect);
+	if (FrameSpawns >= MaxImpactEffectsPerFrame || SystemSpawns >= MaxImpactEffectsPerSystem)
+	{
+		INC_DWORD_STAT(STAT_CSImpactEffectsOverBudget);
+		return nullptr;
+	}
+
+	SystemSpawns++;
+	return SpawnPooledEffect(Effect, Location, Rotation);
+}
+
+void UCSImpactEffectSubsystem::SpawnEssentialEffect(UNiagaraSystem* Effect, const FVector& Location, const FRotator& Rotation)
+{
+	if (Effect == nullptr || !CSAreCosmeticsEnabled(GetWorld())) { return; }
+
+	UpdateBudgetFrame();
+
+	//Effects already waiting keep their order
+	if (FrameSpawns < MaxImpactEffectsPerFrame && QueuedEffects.Num() == 0)
+	{
+		if (IsVisibleFromAnyView(Location))
+		{
+			SpawnPooledEffect(Effect, Location, Rotation);
+		}
+		else
+		{
+			INC_DWORD_STAT(STAT_CSImpactEffectsCulled);
+		}
+		return;
+	}
+
+	FCSQueuedImpactEffect& QueuedEffect = QueuedEffects.AddDefaulted_GetRef();
+	QueuedEffect.Effect = Effect;
+	QueuedEffect.Location = Location;
+	QueuedEffect.Rotation = Rotation;
+
+	if (!TimerHandle_QueuedEffects.IsValid())
+	{
+		TimerHandle_QueuedEffects = GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UCSImpactEffectSubsystem::SpawnQueuedEffects);
+	}
+}
+
+void UCSImpactEffectSubsystem::SpawnQueuedEffects()
+{
+	TimerHandle_QueuedEffects.Invalidate();
+
+	UpdateBudgetFrame();
+
+	//At least one effect is spawned each frame so the queue always empties
+	int32 SpawnedEffects = 0;
+	while (SpawnedEffects < QueuedEffects.Num() && (SpawnedEffects == 0 || FrameSpawns < MaxImpactEffectsPerFrame))
+	{
+		const FCSQueuedImpactEffect& QueuedEffect = QueuedEffects[SpawnedEffects++];
+		if (QueuedEffect.Effect == nullptr) { continue; }
+
+		//The view moved since the effect was queued
+		if (IsVisibleFromAnyView(QueuedEffect.Location))
+		{
+			SpawnPooledEffect(QueuedEffect.Effect, QueuedEffect.Location, QueuedEffect.Rotation);
+		}
+		else
+		{
+			INC_DWORD_STAT(STAT_CSImpactEffectsCulled);
+		}
+	}
+
+	QueuedEffects.RemoveAt(0, SpawnedEffects, false);
+
+	if (QueuedEffects.Num() > 0)
+	{
+		TimerHandle_QueuedEffects = GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UCSImpactEffectSubsystem::SpawnQueuedEffects);
+	}
+}
+
+void UCSImpactEffectSubsystem::UpdateBudgetFrame()
+{
+	if (BudgetFrame != GFrameCounter)
+	{
+		BudgetFrame = GFrameCounter;
+		FrameSpawns = 0;
+		FrameSystemSpawns.Reset();
+	}
+}
+
+UNiagaraComponent* UCSImpactEffectSubsystem::SpawnPooledEffect(UNiagaraSystem* Effect, const FVector& Location, const FRotator& Rotation)
+{
+	FrameSpawns++;
+	INC_DWORD_STAT(STAT_CSImpactEffectsSpawned);
+
+	//Finished components go back to the world pool of the system instead of being destroyed
+	return UNiagaraFunctionLibrary::SpawnSystemAtLocation(GetWorld(), Effect, Location, Rotation, FVector(1.0f), true, true, ENCPoolMethod::AutoRelease);
+}
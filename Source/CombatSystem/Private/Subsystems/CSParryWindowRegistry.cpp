@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/CSParryWindowRegistry.h"
+
+#include "CSCharacter.h"
+#include "Actions/CSCharacterState_Parry.h"
+
+void UCSParryWindowRegistry::OpenParryWindow(ACSCharacter* Attacker, float MaxDuration)
+{
+	if (Attacker == nullptr) { return; }
+
+	float CurrentTime = GetWorld()->GetTimeSeconds();
+	RemoveExpiredWindows(CurrentTime);
+
+	//Reopening a window only refreshes it
+	FCSParryWindow* Window = ParryWindows.FindByPredicate([Attacker](const FCSParryWindow& Other) { return Other.Attacker == Attacker; });
+	if (Window == nullptr)
+	{
+		Window = &ParryWindows.AddDefaulted_GetRef();
+		Window->Attacker = Attacker;
+	}
+
+	Window->StartTime = CurrentTime;
+	Window->EndTime = CurrentTime + MaxDuration;
+
+	//A defender that was already parrying catches the attack as soon as it becomes parriable
+	UCSCharacterState_Parry* ClosestParryState = nullptr;
+	float ClosestDistance = TNumericLimits<float>::Max();
+	for (const FCSActiveParry& Parry : ActiveParries)
+	{
+		ACSCharacter* Defender = Parry.Defender.Get();
+		if (Defender && Parry.ParryState.IsValid() && CanParry(Defender, Parry.Range, *Window, CurrentTime))
+		{
+			float Distance = FVector::Distance(Attacker->GetActorLocation(), Defender->GetActorLocation());
+			if (Distance < ClosestDistance)
+			{
+				ClosestDistance = Distance;
+				ClosestParryState = Parry.ParryState.Get();
+			}
+		}
+	}
+
+	if (ClosestParryState)
+	{
+		ClosestParryState->OnParrySucceeded(Attacker);
+	}
+}
+
+void UCSParryWindowRegistry::CloseParryWindow(ACSCharacter* Attacker)
+{
+	ParryWindows.RemoveAllSwap([Attacker](const FCSParryWindow& Window) { return !Window.Attacker.IsValid() || Window.Attacker == Attacker; });
+}
+
+bool UCSParryWindowRegistry::HasActiveParryWindow(const ACSCharacter* Attacker) const
+{
+	float CurrentTime = GetWorld()->GetTimeSeconds();
+	for (const FCSParryWindow& Window : ParryWindows)
+	{
+		if (Window.Attacker == Attacker && Window.StartTime <= CurrentTime && CurrentTime <= Window.EndTime)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void UCSParryWindowRegistry::BeginParry(ACSCharacter* Defender, UCSCharacterState_Parry* ParryState, float Range)
+{
+	if (Defender == nullptr || ParryState == nullptr) { return; }
+
+	float CurrentTime = GetWorld()->GetTimeSeconds();
+	RemoveExpiredWindows(CurrentTime);
+
+	//Resolve against the windows that are already open, picking the nearest one like the old nearby enemies scan
+	ACSCharacter* ClosestAttacker = nullptr;
+	float ClosestDistance = TNumericLimits<float>::Max();
+	for (const FCSParryWindow& Window : ParryWindows)
+	{
+		if (CanParry(Defender, Range, Window, CurrentTime))
+		{
+			float Distance = FVector::Distance(Window.Attacker->GetActorLocation(), Defender->GetActorLocation());
+			if (Distance < ClosestDistance)
+			{
+				ClosestDistance = Distance;
+				ClosestAttacker = Window.Attacker.Get();
+			}
+		}
+	}
+
+	if (ClosestAttacker)
+	{
+		ParryState->OnParrySucceeded(ClosestAttacker);
+		return;
+	}
+
+	//Nothing to parry yet, wait for an attacker to open its window
+	EndParry(Defender);
+
+	FCSActiveParry& Parry = ActiveParries.AddDefaulted_GetRef();
+	Parry.Defender = Defender;
+	Parry.ParryState = ParryState;
+	Parry.Range = Range;
+}
+
+void UCSParryWindowRegistry::EndParry(ACSCharacter* Defender)
+{
+	ActiveParries.RemoveAllSwap([Defender](const FCSActiveParry& Parry) { return !Parry.Defender.IsValid() || Parry.Defender == Defender; });
+}
+
+void UCSParryWindowRegistry::RemoveExpiredWindows(float CurrentTime)
+{
+	ParryWindows.RemoveAllSwap([CurrentTime](const FCSParryWindow& Window) { return !Window.Attacker.IsValid() || Window.EndTime < CurrentTime; });
+}
+
+bool UCSParryWindowRegistry::CanParry(ACSCharacter* Defender, float Range, const FCSParryWindow& Window, float Time) const
+{
+	ACSCharacter* Attacker = Window.Attacker.Get();
+	if (Attacker == nullptr || Attacker == Defender) { return false; }
+
+	if (Time < Window.StartTime || Time > Window.EndTime) { return false; }
+
+	//Attackers keep moving while their window is open, always measured from where they are now
+	if (FVector::Distance(Attacker->GetActorLocation(), Defender->GetActorLocation()) > Range) { return false; }
+
+	return Defender->IsFacingActor(Attacker);
+}
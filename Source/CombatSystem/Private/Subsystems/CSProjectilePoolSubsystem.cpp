@@ -0,0 +1,174 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/CSProjectilePoolSubsystem.h"
+
+#include "CSProjectile.h"
+#include "../../CombatSystem.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active Projectiles"), STAT_CSActiveProjectiles, STATGROUP_CombatSystem);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled Projectiles"), STAT_CSPooledProjectiles, STATGROUP_CombatSystem);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectile High Water Mark"), STAT_CSProjectileHighWaterMark, STATGROUP_CombatSystem);
+
+void UCSProjectilePoolSubsystem::Deinitialize()
+{
+	for (const TPair<TSubclassOf<ACSProjectile>, FCSProjectilePool>& Pool : Pools)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Projectile pool %s: %d projectiles, high water mark %d"), *GetNameSafe(Pool.Key), Pool.Value.FreeProjectiles.Num() + Pool.Value.ActiveProjectiles.Num(), Pool.Value.HighWaterMark);
+
+		DEC_DWORD_STAT_BY(STAT_CSActiveProjectiles, Pool.Value.ActiveProjectiles.Num());
+		DEC_DWORD_STAT_BY(STAT_CSPooledProjectiles, Pool.Value.FreeProjectiles.Num() + Pool.Value.ActiveProjectiles.Num());
+	}
+
+	Pools.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCSProjectilePoolSubsystem::PrewarmPool(TSubclassOf<ACSProjectile> ProjectileClass, int32 Count, int32 MaxProjectiles)
+{
+	if (ProjectileClass == nullptr) { return; }
+
+	FCSProjectilePool& Pool = Pools.FindOrAdd(ProjectileClass);
+	Pool.MaxProjectiles = FMath::Max(Pool.MaxProjectiles, MaxProjectiles);
+
+	int32 TargetCount = Pool.MaxProjectiles > 0 ? FMath::Min(Count, Pool.MaxProjectiles) : Count;
+	while (Pool.FreeProjectiles.Num() + Pool.ActiveProjectiles.Num() < TargetCount)
+	{
+		ACSProjectile* Projectile = SpawnPooledProjectile(ProjectileClass);
+		if (Projectile == nullptr) { break; }
+
+		Pool.FreeProjectiles.Add(Projectile);
+	}
+}
+
+ACSProjectile* UCSProjectilePoolSubsystem::AcquireProjectile(TSubclassOf<ACSProjectile> ProjectileClass, const FTransform& SpawnTransform, AActor* NewOwner)
+{
+	if (ProjectileClass == nullptr) { return nullptr; }
+
+	FCSProjectilePool& Pool = Pools.FindOrAdd(ProjectileClass);
+
+	//Projectiles destroyed by someone else, such as a level unload, are dropped from the pool
+	int32 RemovedFreeProjectiles = Pool.FreeProjectiles.RemoveAllSwap([](ACSProjectile* Projectile) { return !IsValid(Projectile); });
+	int32 RemovedActiveProjectiles = Pool.ActiveProjectiles.RemoveAll([](ACSProjectile* Projectile) { return !IsValid(Projectile); });
+	DEC_DWORD_STAT_BY(STAT_CSActiveProjectiles, RemovedActiveProjectiles);
+	DEC_DWORD_STAT_BY(STAT_CSPooledProjectiles, RemovedFreeProjectiles + RemovedActiveProjectiles);
+
+	ACSProjectile* Projectile = nullptr;
+	if (Pool.FreeProjectiles.Num() > 0)
+	{
+		Projectile = Pool.FreeProjectiles.Pop(false);
+	}
+	else if (Pool.MaxProjectiles > 0 && Pool.ActiveProjectiles.Num() >= Pool.MaxProjectiles)
+	{
+		//Only arrows left stuck in the world are taken back, the ones still flying may yet hit something
+		int32 SettledIndex = Pool.ActiveProjectiles.IndexOfByPredicate([](ACSProjectile* ActiveProjectile) { return ActiveProjectile->IsSettled(); });
+		if (SettledIndex != INDEX_NONE)
+		{
+			Projectile = Pool.ActiveProjectiles[SettledIndex];
+			Pool.ActiveProjectiles.RemoveAt(SettledIndex, 1, false);
+			Projectile->DeactivateProjectile();
+			DEC_DWORD_STAT(STAT_CSActiveProjectiles);
+		}
+	}
+
+	if (Projectile == nullptr)
+	{
+		Projectile = SpawnPooledProjectile(ProjectileClass);
+	}
+
+	if (Projectile == nullptr) { return nullptr; }
+
+	Pool.ActiveProjectiles.Add(Projectile);
+	INC_DWORD_STAT(STAT_CSActiveProjectiles);
+
+	if (Pool.ActiveProjectiles.Num() > Pool.HighWaterMark)
+	{
+		Pool.HighWaterMark = Pool.ActiveProjectiles.Num();
+		SET_DWORD_STAT(STAT_CSProjectileHighWaterMark, Pool.HighWaterMark);
+	}
+
+	Projectile->ActivateProjectile(SpawnTransform, NewOwner);
+
+	return Projectile;
+}
+
+void UCSProjectilePoolSubsystem::ReleaseProjectile(ACSProjectile* Projectile)
+{
+	if (Projectile == nullptr) { return; }
+
+	FCSProjectilePool* Pool = Pools.Find(Projectile->GetClass());
+	if (Pool == nullptr || Pool->ActiveProjectiles.Remove(Projectile) == 0)
+	{
+		//Not pooled, such as projectiles placed in the level
+		Projectile->Destroy();
+		return;
+	}
+
+	DEC_DWORD_STAT(STAT_CSActiveProjectiles);
+
+	Projectile->DeactivateProjectile();
+	Pool->FreeProjectiles.Add(Projectile);
+}
+
+void UCSProjectilePoolSubsystem::ReleaseAllProjectiles()
+{
+	for (TPair<TSubclassOf<ACSProjectile>, FCSProjectilePool>& Pool : Pools)
+	{
+		for (ACSProjectile* Projectile : Pool.Value.ActiveProjectiles)
+		{
+			if (!IsValid(Projectile)) { continue; }
+
+			Projectile->DeactivateProjectile();
+			Pool.Value.FreeProjectiles.Add(Projectile);
+		}
+
+		DEC_DWORD_STAT_BY(STAT_CSActiveProjectiles, Pool.Value.ActiveProjectiles.Num());
+		Pool.Value.ActiveProjectiles.Reset();
+	}
+}
+
+int32 UCSProjectilePoolSubsystem::GetHighWaterMark(TSubclassOf<ACSProjectile> ProjectileClass) const
+{
+	const FCSProjectilePool* Pool = Pools.Find(ProjectileClass);
+	return Pool ? Pool->HighWaterMark : 0;
+}
+
+int32 UCSProjectilePoolSubsystem::GetMaxProjectiles(TSubclassOf<ACSProjectile> ProjectileClass) const
+{
+	const FCSProjectilePool* Pool = Pools.Find(ProjectileClass);
+	return Pool ? Pool->MaxProjectiles : 0;
+}
+
+void UCSProjectilePoolSubsystem::SetMaxProjectiles(TSubclassOf<ACSProjectile> ProjectileClass, int32 MaxProjectiles)
+{
+	FCSProjectilePool* Pool = Pools.Find(ProjectileClass);
+	if (Pool == nullptr) { return; }
+
+	Pool->MaxProjectiles = MaxProjectiles;
+	if (MaxProjectiles <= 0) { return; }
+
+	while (Pool->FreeProjectiles.Num() > 0 && Pool->FreeProjectiles.Num() + Pool->ActiveProjectiles.Num() > MaxProjectiles)
+	{
+		ACSProjectile* Projectile = Pool->FreeProjectiles.Pop(false);
+		if (IsValid(Projectile)) { Projectile->Destroy(); }
+		DEC_DWORD_STAT(STAT_CSPooledProjectiles);
+	}
+}
+
+ACSProjectile* UCSProjectilePoolSubsystem::SpawnPooledProjectile(TSubclassOf<ACSProjectile> ProjectileClass)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	ACSProjectile* Projectile = GetWorld()->SpawnActor<ACSProjectile>(ProjectileClass, FTransform::Identity, SpawnParams);
+	if (Projectile == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Could not spawn a pooled projectile of class %s"), *GetNameSafe(ProjectileClass));
+		return nullptr;
+	}
+
+	Projectile->DeactivateProjectile();
+	INC_DWORD_STAT(STAT_CSPooledProjectiles);
+
+	return Projectile;
+}
@@ -0,0 +1,435 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/CSProjectileSimulationSubsystem.h"
+
+#include "CSProjectile.h"
+#include "CSCharacter.h"
+#include "Equipment/CSRangedWeapon.h"
+#include "Subsystems/CSProjectilePoolSubsystem.h"
+#include "Components/BoxComponent.h"
+#include "GameFramework/WorldSettings.h"
+#include "Kismet/GameplayStatics.h"
+#include "HAL/PlatformTime.h"
+#include "CoreGlobals.h"
+#include "../../CombatSystem.h"
+
+static int32 UseProjectileSimulation = 1;
+FAutoConsoleVariableRef CVARUseProjectileSimulation(
+	TEXT("CS.UseProjectileSimulation"),
+	UseProjectileSimulation,
+	TEXT("Fly arrows with the analytic projectile simulation instead of physics bodies"),
+	ECVF_Cheat);
+
+static float MaxProjectileFlightTime = 10.0f;
+FAutoConsoleVariableRef CVARMaxProjectileFlightTime(
+	TEXT("CS.MaxProjectileFlightTime"),
+	MaxProjectileFlightTime,
+	TEXT("Simulated projectiles that didn't hit anything after this time are returned to their pool"),
+	ECVF_Cheat);
+
+static void StartProjectileBenchmark(const TArray<FString>& Args, UWorld* World)
+{
+	ACSCharacter* PlayerCharacter = Cast<ACSCharacter>(UGameplayStatics::GetPlayerCharacter(World, 0));
+	ACSRangedWeapon* RangedWeapon = PlayerCharacter ? PlayerCharacter->GetCurrentRangedWeapon() : nullptr;
+	UCSProjectileSimulationSubsystem* ProjectileSimulation = World ? World->GetSubsystem<UCSProjectileSimulationSubsystem>() : nullptr;
+	if (RangedWeapon == nullptr || ProjectileSimulation == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("The projectile benchmark needs a player character with a ranged weapon"));
+		return;
+	}
+
+	int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000;
+	float Duration = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 5.0f;
+	float LaunchSpeed = Args.Num() > 2 ? FCString::Atof(*Args[2]) : 3000.0f;
+
+	FVector Origin = PlayerCharacter->GetActorLocation() + FVector(0.0f, 0.0f, 200.0f);
+	ProjectileSimulation->StartBenchmark(RangedWeapon->GetProjectileClass(), Origin, LaunchSpeed, FMath::Max(Count, 1), FMath::Max(Duration, 0.1f));
+}
+
+FAutoConsoleCommandWithWorldAndArgs CVARProjectileBenchmark(
+	TEXT("CS.ProjectileBenchmark"),
+	TEXT("CS.ProjectileBenchmark [Count] [Seconds] [Speed]: shoots arrows around the player with physics and then with the analytic simulation, logging the average frame cost of each"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&StartProjectileBenchmark),
+	ECVF_Cheat);
+
+DECLARE_CYCLE_STAT(TEXT("Projectile Simulation"), STAT_CSProjectileSimulation, STATGROUP_CombatSystem);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Simulated Projectiles"), STAT_CSSimulatedProjectiles, STATGROUP_CombatSystem);
+
+void FCSProjectileSimulationTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Subsystem)
+	{
+		Subsystem->Simulate(DeltaTime);
+	}
+}
+
+FString FCSProjectileSimulationTickFunction::DiagnosticMessage()
+{
+	return TEXT("FCSProjectileSimulationTickFunction");
+}
+
+bool UCSProjectileSimulationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCSProjectileSimulationSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	BenchmarkPhase = CSProjectileBenchmarkPhase::NONE;
+	BenchmarkPreviousMaxProjectiles = 0;
+
+	//Before physics like the arrows it replaces, so hits reach the hit resolution stage in the same frame
+	SimulationTickFunction.Subsystem = this;
+	SimulationTickFunction.bCanEverTick = true;
+	SimulationTickFunction.bStartWithTickEnabled = true;
+	SimulationTickFunction.TickGroup = TG_PrePhysics;
+	SimulationTickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void UCSProjectileSimulationSubsystem::Deinitialize()
+{
+	if (SimulationTickFunction.IsTickFunctionRegistered())
+	{
+		SimulationTickFunction.UnRegisterTickFunction();
+	}
+
+	DEC_DWORD_STAT_BY(STAT_CSSimulatedProjectiles, Projectiles.Num());
+
+	Super::Deinitialize();
+}
+
+bool UCSProjectileSimulationSubsystem::IsSimulationEnabled()
+{
+	return UseProjectileSimulation > 0;
+}
+
+void UCSProjectileSimulationSubsystem::AddProjectile(ACSProjectile* Projectile, const FVector& Velocity)
+{
+	if (Projectile == nullptr) { return; }
+
+	UBoxComponent* CollisionComp = Projectile->GetCollisionComponent();
+	FVector::FReal GravityScale = CollisionComp->IsGravityEnabled() ? 1.0 : 0.0;
+	FVector::FReal LinearDamping = CollisionComp->GetLinearDamping();
+
+	Projectile->BeginSimulatedFlight();
+
+	FVector Position = Projectile->GetActorLocation();
+
+	Projectiles.Add(Projectile);
+	Owners.Add(Projectile->GetOwner());
+	PositionsX.Add(Position.X);
+	PositionsY.Add(Position.Y);
+	PositionsZ.Add(Position.Z);
+	VelocitiesX.Add(Velocity.X);
+	VelocitiesY.Add(Velocity.Y);
+	VelocitiesZ.Add(Velocity.Z);
+	GravityScales.Add(GravityScale);
+	LinearDampings.Add(LinearDamping);
+	DamageMultipliers.Add(Projectile->GetDamageMultiplier());
+	Ages.Add(0.0f);
+
+	INC_DWORD_STAT(STAT_CSSimulatedProjectiles);
+}
+
+void UCSProjectileSimulationSubsystem::RemoveProjectile(ACSProjectile* Projectile)
+{
+	int32 Index = Projectiles.Find(Projectile);
+	if (Index != INDEX_NONE)
+	{
+		RemoveProjectileAt(Index);
+	}
+}
+
+void UCSProjectileSimulationSubsystem::RemoveProjectileAt(int32 Index)
+{
+	Projectiles.RemoveAtSwap(Index, 1, false);
+	Owners.RemoveAtSwap(Index, 1, false);
+	PositionsX.RemoveAtSwap(Index, 1, false);
+	PositionsY.RemoveAtSwap(Index, 1, false);
+	PositionsZ.RemoveAtSwap(Index, 1, false);
+	VelocitiesX.RemoveAtSwap(Index, 1, false);
+	VelocitiesY.RemoveAtSwap(Index, 1, false);
+	VelocitiesZ.RemoveAtSwap(Index, 1, false);
+	GravityScales.RemoveAtSwap(Index, 1, false);
+	LinearDampings.RemoveAtSwap(Index, 1, false);
+	DamageMultipliers.RemoveAtSwap(Index, 1, false);
+	Ages.RemoveAtSwap(Index, 1, false);
+
+	DEC_DWORD_STAT(STAT_CSSimulatedProjectiles);
+}
+
+void UCSProjectileSimulationSubsystem::Simulate(float DeltaTime)
+{
+	double StartTime = FPlatformTime::Seconds();
+
+	if (Projectiles.Num() > 0)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_CSProjectileSimulation);
+
+		Integrate(DeltaTime);
+		TraceSteps();
+		ResolveImpacts();
+		UpdateVisuals();
+	}
+
+	if (BenchmarkPhase != CSProjectileBenchmarkPhase::NONE)
+	{
+		UpdateBenchmark((FPlatformTime::Seconds() - StartTime) * 1000.0);
+	}
+}
+
+void UCSProjectileSimulationSubsystem::Integrate(float DeltaTime)
+{
+	const int32 NumProjectiles = Projectiles.Num();
+
+	StepStarts.SetNumUninitialized(NumProjectiles, false);
+	for (int32 i = 0; i < NumProjectiles; ++i)
+	{
+		StepStarts[i] = FVector(PositionsX[i], PositionsY[i], PositionsZ[i]);
+	}
+
+	const FVector::FReal Step = DeltaTime;
+	const FVector::FReal GravityStep = GetWorld()->GetGravityZ() * Step;
+
+	FVector::FReal* RESTRICT PX = PositionsX.GetData();
+	FVector::FReal* RESTRICT PY = PositionsY.GetData();
+	FVector::FReal* RESTRICT PZ = PositionsZ.GetData();
+	FVector::FReal* RESTRICT VX = VelocitiesX.GetData();
+	FVector::FReal* RESTRICT VY = VelocitiesY.GetData();
+	FVector::FReal* RESTRICT VZ = VelocitiesZ.GetData();
+	const FVector::FReal* RESTRICT Gravity = GravityScales.GetData();
+	const FVector::FReal* RESTRICT Damping = LinearDampings.GetData();
+
+	//Semi-implicit Euler over flat arrays without branches so the compiler can vectorise every loop
+	for (int32 i = 0; i < NumProjectiles; ++i)
+	{
+		VZ[i] += GravityStep * Gravity[i];
+	}
+
+	for (int32 i = 0; i < NumProjectiles; ++i)
+	{
+		FVector::FReal DampingFactor = FMath::Max(1.0 - Damping[i] * Step, 0.0);
+		VX[i] *= DampingFactor;
+		VY[i] *= DampingFactor;
+		VZ[i] *= DampingFactor;
+	}
+
+	for (int32 i = 0; i < NumProjectiles; ++i)
+	{
+		PX[i] += VX[i] * Step;
+		PY[i] += VY[i] * Step;
+		PZ[i] += VZ[i] * Step;
+	}
+
+	for (int32 i = 0; i < NumProjectiles; ++i)
+	{
+		Ages[i] += DeltaTime;
+	}
+}
+
+void UCSProjectileSimulationSubsystem::TraceSteps()
+{
+	HitIndices.Reset();
+	StepHits.Reset();
+
+	TArray<FHitResult> TraceHits;
+	for (int32 i = 0; i < Projectiles.Num(); ++i)
+	{
+		ACSProjectile* Projectile = Projectiles[i];
+		if (!IsValid(Projectile)) { continue; }
+
+		AActor* ProjectileOwner = Owners[i].Get();
+
+		//The hit carries the physical material so the impact needs no other query
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ProjectileSimulationTrace), false, Projectile);
+		QueryParams.bReturnPhysicalMaterial = true;
+		if (ProjectileOwner) { QueryParams.AddIgnoredActor(ProjectileOwner); }
+
+		//Trace with the responses of the arrow collision so it hits what its overlaps used to
+		UBoxComponent* CollisionComp = Projectile->GetCollisionComponent();
+		FCollisionResponseParams ResponseParams(CollisionComp->GetCollisionResponseToChannels());
+
+		FVector StepEnd(PositionsX[i], PositionsY[i], PositionsZ[i]);
+
+		TraceHits.Reset();
+		GetWorld()->LineTraceMultiByChannel(TraceHits, StepStarts[i], StepEnd, CollisionComp->GetCollisionObjectType(), QueryParams, ResponseParams);
+
+		const FHitResult* FirstHit = nullptr;
+		for (const FHitResult& Hit : TraceHits)
+		{
+			AActor* HitActor = Hit.GetActor();
+			if (HitActor == nullptr || (ProjectileOwner && HitActor->GetOwner() == ProjectileOwner)) { continue; }
+
+			if (FirstHit == nullptr || Hit.Time < FirstHit->Time)
+			{
+				FirstHit = &Hit;
+			}
+		}
+
+		if (FirstHit)
+		{
+			HitIndices.Add(i);
+			StepHits.Add(*FirstHit);
+		}
+	}
+}
+
+void UCSProjectileSimulationSubsystem::ResolveImpacts()
+{
+	struct FCSProjectileImpact
+	{
+		ACSProjectile* Projectile;
+		FHitResult Hit;
+		FVector Velocity;
+		float DamageMultiplier;
+	};
+
+	TArray<FCSProjectileImpact, TInlineAllocator<16>> Impacts;
+	TArray<ACSProjectile*, TInlineAllocator<16>> ExpiredProjectiles;
+	TArray<int32, TInlineAllocator<32>> RemovedIndices;
+
+	float KillZ = GetWorld()->GetWorldSettings()->KillZ;
+
+	int32 HitCursor = 0;
+	for (int32 i = 0; i < Projectiles.Num(); ++i)
+	{
+		if (HitCursor < HitIndices.Num() && HitIndices[HitCursor] == i)
+		{
+			FCSProjectileImpact& Impact = Impacts.AddDefaulted_GetRef();
+			Impact.Projectile = Projectiles[i];
+			Impact.Hit = StepHits[HitCursor];
+			Impact.Velocity = FVector(VelocitiesX[i], VelocitiesY[i], VelocitiesZ[i]);
+			Impact.DamageMultiplier = DamageMultipliers[i];
+
+			RemovedIndices.Add(i);
+			HitCursor++;
+		}
+		else if (!IsValid(Projectiles[i]) || Ages[i] > MaxProjectileFlightTime || PositionsZ[i] < KillZ)
+		{
+			if (IsValid(Projectiles[i])) { ExpiredProjectiles.Add(Projectiles[i]); }
+
+			RemovedIndices.Add(i);
+		}
+	}
+
+	//Leave the simulation first, impacts can send projectiles back to their pool
+	for (int32 i = RemovedIndices.Num() - 1; i >= 0; --i)
+	{
+		RemoveProjectileAt(RemovedIndices[i]);
+	}
+
+	for (const FCSProjectileImpact& Impact : Impacts)
+	{
+		if (!IsValid(Impact.Projectile)) { continue; }
+
+		Impact.Projectile->EndSimulatedFlight(Impact.Hit.Location, Impact.Velocity);
+		Impact.Projectile->SetDamageMultiplier(Impact.DamageMultiplier);
+		Impact.Projectile->OnImpact(Impact.Hit);
+	}
+
+	for (ACSProjectile* Projectile : ExpiredProjectiles)
+	{
+		Projectile->EndSimulatedFlight(Projectile->GetActorLocation(), FVector::ZeroVector);
+		Projectile->ReturnToPool();
+	}
+}
+
+void UCSProjectileSimulationSubsystem::UpdateVisuals()
+{
+	for (int32 i = 0; i < Projectiles.Num(); ++i)
+	{
+		FVector Velocity(VelocitiesX[i], VelocitiesY[i], VelocitiesZ[i]);
+		Projectiles[i]->SetActorLocationAndRotation(FVector(PositionsX[i], PositionsY[i], PositionsZ[i]), Velocity.Rotation(), false, nullptr, ETeleportType::TeleportPhysics);
+	}
+}
+
+//Benchmark ===============================================================================================
+void UCSProjectileSimulationSubsystem::StartBenchmark(TSubclassOf<ACSProjectile> ProjectileClass, const FVector& Origin, float LaunchSpeed, int32 Count, float Duration)
+{
+	if (BenchmarkPhase != CSProjectileBenchmarkPhase::NONE)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("A projectile benchmark is already running"));
+		return;
+	}
+
+	UCSProjectilePoolSubsystem* ProjectilePool = GetWorld()->GetSubsystem<UCSProjectilePoolSubsystem>();
+	if (ProjectilePool == nullptr || ProjectileClass == nullptr) { return; }
+
+	BenchmarkProjectileClass = ProjectileClass;
+	BenchmarkOrigin = Origin;
+	BenchmarkLaunchSpeed = LaunchSpeed;
+	BenchmarkProjectileCount = Count;
+	BenchmarkDuration = Duration;
+
+	//Spawn every projectile up front so neither phase pays for actor spawning
+	BenchmarkPreviousMaxProjectiles = ProjectilePool->GetMaxProjectiles(ProjectileClass);
+	ProjectilePool->PrewarmPool(ProjectileClass, Count, Count);
+
+	StartBenchmarkPhase(CSProjectileBenchmarkPhase::PHYSICS);
+}
+
+void UCSProjectileSimulationSubsystem::StartBenchmarkPhase(CSProjectileBenchmarkPhase Phase)
+{
+	BenchmarkPhase = Phase;
+	BenchmarkFrames = 0;
+	BenchmarkGameThreadMilliseconds = 0.0;
+	BenchmarkSimulationMilliseconds = 0.0;
+	BenchmarkPhaseEndTime = GetWorld()->GetTimeSeconds() + BenchmarkDuration;
+
+	UCSProjectilePoolSubsystem* ProjectilePool = GetWorld()->GetSubsystem<UCSProjectilePoolSubsystem>();
+
+	if (Phase == CSProjectileBenchmarkPhase::NONE)
+	{
+		//The weapons go back to their own cap and the extra arrows are dropped
+		if (ProjectilePool) { ProjectilePool->SetMaxProjectiles(BenchmarkProjectileClass, BenchmarkPreviousMaxProjectiles); }
+		return;
+	}
+
+	APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(GetWorld(), 0);
+
+	//Same deterministic fan of arrows for both phases
+	FRandomStream RandomStream(BenchmarkProjectileCount);
+	for (int32 i = 0; i < BenchmarkProjectileCount; ++i)
+	{
+		FRotator LaunchRotation(RandomStream.FRandRange(20.0f, 60.0f), i * 137.5f, 0.0f);
+
+		ACSProjectile* Projectile = ProjectilePool->AcquireProjectile(BenchmarkProjectileClass, FTransform(LaunchRotation, BenchmarkOrigin), PlayerPawn);
+		if (Projectile == nullptr) { break; }
+
+		//Shot in the name of the player but never hurts anyone
+		Projectile->SetCosmetic(true);
+
+		UBoxComponent* CollisionComp = Projectile->GetCollisionComponent();
+		FVector Impulse = LaunchRotation.Vector() * BenchmarkLaunchSpeed * (CollisionComp->IsSimulatingPhysics() ? CollisionComp->GetMass() : 1.0f);
+		Projectile->Launch(Impulse, Phase == CSProjectileBenchmarkPhase::SIMULATED);
+
+		BenchmarkProjectiles.Add(Projectile);
+	}
+}
+
+void UCSProjectileSimulationSubsystem::UpdateBenchmark(double SimulationMilliseconds)
+{
+	BenchmarkFrames++;
+	BenchmarkGameThreadMilliseconds += FPlatformTime::ToMilliseconds(GGameThreadTime);
+	BenchmarkSimulationMilliseconds += SimulationMilliseconds;
+
+	if (GetWorld()->GetTimeSeconds() < BenchmarkPhaseEndTime) { return; }
+
+	UE_LOG(LogTemp, Display, TEXT("Projectile benchmark, %s: %d projectiles over %d frames, game thread %.3f ms, analytic simulation %.3f ms per frame"),
+		BenchmarkPhase == CSProjectileBenchmarkPhase::PHYSICS ? TEXT("physics") : TEXT("simulated"), BenchmarkProjectileCount, BenchmarkFrames,
+		BenchmarkGameThreadMilliseconds / BenchmarkFrames, BenchmarkSimulationMilliseconds / BenchmarkFrames);
+
+	UCSProjectilePoolSubsystem* ProjectilePool = GetWorld()->GetSubsystem<UCSProjectilePoolSubsystem>();
+	for (ACSProjectile* Projectile : BenchmarkProjectiles)
+	{
+		if (IsValid(Projectile) && Projectile->IsInUse() && ProjectilePool)
+		{
+			ProjectilePool->ReleaseProjectile(Projectile);
+		}
+	}
+	BenchmarkProjectiles.Reset();
+
+	StartBenchmarkPhase(BenchmarkPhase == CSProjectileBenchmarkPhase::PHYSICS ? CSProjectileBenchmarkPhase::SIMULATED : CSProjectileBenchmarkPhase::NONE);
+}
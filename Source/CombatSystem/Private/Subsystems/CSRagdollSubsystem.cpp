@@ -0,0 +1,146 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/CSRagdollSubsystem.h"
+
+#include "Components/SkeletalMeshComponent.h"
+#include "PhysicsEngine/BodyInstance.h"
+#include "TimerManager.h"
+#include "../../CombatSystem.h"
+
+static int32 MaxSimulatedRagdolls = 6;
+FAutoConsoleVariableRef CVARMaxSimulatedRagdolls(
+	TEXT("CS.MaxSimulatedRagdolls"),
+	MaxSimulatedRagdolls,
+	TEXT("Maximum number of ragdolls simulated at the same time, the oldest one is frozen past it"),
+	ECVF_Cheat);
+
+static float RagdollSettleSpeed = 15.0f;
+FAutoConsoleVariableRef CVARRagdollSettleSpeed(
+	TEXT("CS.RagdollSettleSpeed"),
+	RagdollSettleSpeed,
+	TEXT("Ragdolls whose bodies all move slower than this are considered settled"),
+	ECVF_Cheat);
+
+static int32 RagdollSettleChecks = 5;
+FAutoConsoleVariableRef CVARRagdollSettleChecks(
+	TEXT("CS.RagdollSettleChecks"),
+	RagdollSettleChecks,
+	TEXT("Consecutive checks, every 0.1 seconds, a ragdoll has to stay settled before it is frozen"),
+	ECVF_Cheat);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Simulated Ragdolls"), STAT_CSSimulatedRagdolls, STATGROUP_CombatSystem);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Ragdolls Frozen"), STAT_CSFrozenRagdolls, STATGROUP_CombatSystem);
+
+bool UCSRagdollSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	//Not created at all in server builds
+	return CS_WITH_COSMETICS && (WorldType == EWorldType::Game || WorldType == EWorldType::PIE);
+}
+
+void UCSRagdollSubsystem::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_CSSimulatedRagdolls, Ragdolls.Num());
+	DEC_DWORD_STAT_BY(STAT_CSFrozenRagdolls, FrozenRagdolls);
+
+	Ragdolls.Empty();
+	FrozenRagdolls = 0;
+
+	Super::Deinitialize();
+}
+
+void UCSRagdollSubsystem::AddRagdoll(USkeletalMeshComponent* Mesh)
+{
+	if (Mesh == nullptr || !CSAreCosmeticsEnabled(GetWorld())) { return; }
+
+	//FIFO, the oldest ragdoll makes room for the new one
+	while (Ragdolls.Num() > 0 && Ragdolls.Num() >= MaxSimulatedRagdolls)
+	{
+		USkeletalMeshComponent* OldestMesh = Ragdolls[0].Mesh.Get();
+		Ragdolls.RemoveAt(0, 1, false);
+		DEC_DWORD_STAT(STAT_CSSimulatedRagdolls);
+
+		if (OldestMesh) { FreezeRagdoll(OldestMesh); }
+	}
+
+	if (MaxSimulatedRagdolls <= 0)
+	{
+		FreezeRagdoll(Mesh);
+		return;
+	}
+
+	Mesh->SetSimulatePhysics(true);
+
+	FCSRagdoll& Ragdoll = Ragdolls.AddDefaulted_GetRef();
+	Ragdoll.Mesh = Mesh;
+	INC_DWORD_STAT(STAT_CSSimulatedRagdolls);
+
+	if (!GetWorld()->GetTimerManager().IsTimerActive(TimerHandle_CheckSettled))
+	{
+		GetWorld()->GetTimerManager().SetTimer(TimerHandle_CheckSettled, this, &UCSRagdollSubsystem::CheckSettled, 0.1f, true);
+	}
+}
+
+void UCSRagdollSubsystem::RemoveRagdoll(USkeletalMeshComponent* Mesh)
+{
+	int32 RemovedRagdolls = Ragdolls.RemoveAll([Mesh](const FCSRagdoll& Ragdoll) { return Ragdoll.Mesh.Get() == Mesh; });
+	DEC_DWORD_STAT_BY(STAT_CSSimulatedRagdolls, RemovedRagdolls);
+}
+
+void UCSRagdollSubsystem::CheckSettled()
+{
+	float SettleSpeedSquared = RagdollSettleSpeed * RagdollSettleSpeed;
+
+	for (int32 i = Ragdolls.Num() - 1; i >= 0; --i)
+	{
+		FCSRagdoll& Ragdoll = Ragdolls[i];
+		USkeletalMeshComponent* Mesh = Ragdoll.Mesh.Get();
+
+		//Corpses destroyed at the end of the wave just leave the list
+		bool Settled = Mesh == nullptr;
+		if (Mesh)
+		{
+			bool Resting = !Mesh->RigidBodyIsAwake() || GetMaxBodySpeedSquared(Mesh) < SettleSpeedSquared;
+			Ragdoll.SettledChecks = Resting ? Ragdoll.SettledChecks + 1 : 0;
+			Settled = Ragdoll.SettledChecks >= RagdollSettleChecks;
+		}
+
+		if (!Settled) { continue; }
+
+		Ragdolls.RemoveAt(i, 1, false);
+		DEC_DWORD_STAT(STAT_CSSimulatedRagdolls);
+
+		if (Mesh) { FreezeRagdoll(Mesh); }
+	}
+
+	if (Ragdolls.Num() == 0)
+	{
+		GetWorld()->GetTimerManager().ClearTimer(TimerHandle_CheckSettled);
+	}
+}
+
+float UCSRagdollSubsystem::GetMaxBodySpeedSquared(USkeletalMeshComponent* Mesh) const
+{
+	float MaxSpeedSquared = 0.0f;
+	for (FBodyInstance* Body : Mesh->Bodies)
+	{
+		if (Body == nullptr || !Body->IsInstanceSimulatingPhysics()) { continue; }
+
+		MaxSpeedSquared = FMath::Max(MaxSpeedSquared, (float)Body->GetUnrealWorldVelocity().SizeSquared());
+	}
+
+	return MaxSpeedSquared;
+}
+
+void UCSRagdollSubsystem::FreezeRagdoll(USkeletalMeshComponent* Mesh)
+{
+	//Without its tick the mesh keeps the bone transforms of the last simulated frame
+	Mesh->PutAllRigidBodiesToSleep();
+	Mesh->SetComponentTickEnabled(false);
+	Mesh->bPauseAnims = true;
+
+	Mesh->SetSimulatePhysics(false);
+	Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+	FrozenRagdolls++;
+	INC_DWORD_STAT(STAT_CSFrozenRagdolls);
+}
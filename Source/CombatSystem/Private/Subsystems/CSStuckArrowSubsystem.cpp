@@ -0,0 +1,204 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystems/CSStuckArrowSubsystem.h"
+
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "TimerManager.h"
+
+static int32 MaxStuckArrows = 200;
+FAutoConsoleVariableRef CVARMaxStuckArrows(
+	TEXT("CS.MaxStuckArrows"),
+	MaxStuckArrows,
+	TEXT("Maximum arrows of the same mesh stuck in the world, the oldest one is removed past it"),
+	ECVF_Cheat);
+
+static float StuckArrowLifetime = 30.0f;
+FAutoConsoleVariableRef CVARStuckArrowLifetime(
+	TEXT("CS.StuckArrowLifetime"),
+	StuckArrowLifetime,
+	TEXT("Seconds before a stuck arrow starts fading out, 0 keeps them until the cap is reached"),
+	ECVF_Cheat);
+
+static float StuckArrowFadeDuration = 1.5f;
+FAutoConsoleVariableRef CVARStuckArrowFadeDuration(
+	TEXT("CS.StuckArrowFadeDuration"),
+	StuckArrowFadeDuration,
+	TEXT("Seconds a stuck arrow takes to fade out"),
+	ECVF_Cheat);
+
+bool UCSStuckArrowSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UCSStuckArrowSubsystem::AddStuckArrow(UStaticMeshComponent* ArrowMesh)
+{
+	if (ArrowMesh == nullptr || ArrowMesh->GetStaticMesh() == nullptr || MaxStuckArrows <= 0) { return false; }
+
+	FCSStuckArrowBatch* Batch = FindOrCreateBatch(ArrowMesh);
+	if (Batch == nullptr) { return false; }
+
+	//FIFO, the oldest arrow makes room for the new one
+	if (Batch->UsedSlots.Num() >= MaxStuckArrows)
+	{
+		FreeSlot(*Batch, Batch->UsedSlots[0]);
+	}
+
+	FTransform ArrowTransform = ArrowMesh->GetComponentTransform();
+
+	int32 Slot = INDEX_NONE;
+	if (Batch->FreeSlots.Num() > 0)
+	{
+		Slot = Batch->FreeSlots.Pop(false);
+		Batch->InstancedMesh->UpdateInstanceTransform(Slot, ArrowTransform, true, true, true);
+	}
+	else
+	{
+		Slot = Batch->InstancedMesh->AddInstance(ArrowTransform, true);
+		Batch->Slots.AddDefaulted();
+	}
+
+	Batch->InstancedMesh->SetCustomDataValue(Slot, 0, 1.0f, true);
+
+	FCSStuckArrowSlot& ArrowSlot = Batch->Slots[Slot];
+	ArrowSlot.Transform = ArrowTransform;
+	ArrowSlot.StuckTime = GetWorld()->GetTimeSeconds();
+	ArrowSlot.Used = true;
+	Batch->UsedSlots.Add(Slot);
+
+	if (StuckArrowLifetime > 0.0f && !GetWorld()->GetTimerManager().IsTimerActive(TimerHandle_UpdateFades))
+	{
+		GetWorld()->GetTimerManager().SetTimer(TimerHandle_UpdateFades, this, &UCSStuckArrowSubsystem::UpdateFades, 0.1f, true);
+	}
+
+	return true;
+}
+
+void UCSStuckArrowSubsystem::ClearStuckArrows()
+{
+	GetWorld()->GetTimerManager().ClearTimer(TimerHandle_UpdateFades);
+
+	for (TPair<UStaticMesh*, FCSStuckArrowBatch>& BatchPair : Batches)
+	{
+		FCSStuckArrowBatch& Batch = BatchPair.Value;
+		if (Batch.InstancedMesh == nullptr) { continue; }
+
+		while (Batch.UsedSlots.Num() > 0)
+		{
+			FreeSlot(Batch, Batch.UsedSlots.Last());
+		}
+
+		Batch.InstancedMesh->MarkRenderStateDirty();
+	}
+}
+
+FCSStuckArrowBatch* UCSStuckArrowSubsystem::FindOrCreateBatch(UStaticMeshComponent* ArrowMesh)
+{
+	UStaticMesh* StaticMesh = ArrowMesh->GetStaticMesh();
+	if (FCSStuckArrowBatch* Batch = Batches.Find(StaticMesh))
+	{
+		return Batch;
+	}
+
+	if (InstancesActor == nullptr)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		InstancesActor = GetWorld()->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+		if (InstancesActor == nullptr) { return nullptr; }
+
+		USceneComponent* RootComp = NewObject<USceneComponent>(InstancesActor, TEXT("RootComp"));
+		InstancesActor->SetRootComponent(RootComp);
+		RootComp->RegisterComponent();
+	}
+
+	UHierarchicalInstancedStaticMeshComponent* InstancedMesh = NewObject<UHierarchicalInstancedStaticMeshComponent>(InstancesActor);
+	InstancedMesh->SetStaticMesh(StaticMesh);
+	InstancedMesh->SetMobility(EComponentMobility::Movable);
+	InstancedMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	InstancedMesh->SetCastShadow(ArrowMesh->CastShadow);
+
+	//Opacity for materials reading the per instance custom data, faded arrows are also scaled down for the others
+	InstancedMesh->NumCustomDataFloats = 1;
+
+	for (int32 i = 0; i < ArrowMesh->GetNumMaterials(); ++i)
+	{
+		InstancedMesh->SetMaterial(i, ArrowMesh->GetMaterial(i));
+	}
+
+	InstancedMesh->SetupAttachment(InstancesActor->GetRootComponent());
+	InstancedMesh->RegisterComponent();
+	InstancesActor->AddInstanceComponent(InstancedMesh);
+
+	FCSStuckArrowBatch& Batch = Batches.Add(StaticMesh);
+	Batch.InstancedMesh = InstancedMesh;
+
+	return &Batch;
+}
+
+void UCSStuckArrowSubsystem::UpdateFades()
+{
+	float CurrentTime = GetWorld()->GetTimeSeconds();
+	float FadeDuration = FMath::Max(StuckArrowFadeDuration, KINDA_SMALL_NUMBER);
+	bool AnyArrowLeft = false;
+
+	for (TPair<UStaticMesh*, FCSStuckArrowBatch>& BatchPair : Batches)
+	{
+		FCSStuckArrowBatch& Batch = BatchPair.Value;
+		if (Batch.InstancedMesh == nullptr) { continue; }
+
+		//Used slots are sorted by age, stop at the first arrow that doesn't have to fade yet
+		bool BatchChanged = false;
+		while (Batch.UsedSlots.Num() > 0)
+		{
+			int32 Slot = Batch.UsedSlots[0];
+			float Age = CurrentTime - Batch.Slots[Slot].StuckTime;
+			if (Age < StuckArrowLifetime + FadeDuration) { break; }
+
+			FreeSlot(Batch, Slot);
+			BatchChanged = true;
+		}
+
+		for (int32 Slot : Batch.UsedSlots)
+		{
+			const FCSStuckArrowSlot& ArrowSlot = Batch.Slots[Slot];
+			float Age = CurrentTime - ArrowSlot.StuckTime;
+			if (Age < StuckArrowLifetime) { break; }
+
+			float Opacity = 1.0f - (Age - StuckArrowLifetime) / FadeDuration;
+
+			FTransform FadedTransform = ArrowSlot.Transform;
+			FadedTransform.SetScale3D(ArrowSlot.Transform.GetScale3D() * Opacity);
+			Batch.InstancedMesh->UpdateInstanceTransform(Slot, FadedTransform, true, false, true);
+			Batch.InstancedMesh->SetCustomDataValue(Slot, 0, Opacity, false);
+			BatchChanged = true;
+		}
+
+		if (BatchChanged)
+		{
+			Batch.InstancedMesh->MarkRenderStateDirty();
+		}
+
+		AnyArrowLeft |= Batch.UsedSlots.Num() > 0;
+	}
+
+	if (!AnyArrowLeft || StuckArrowLifetime <= 0.0f)
+	{
+		GetWorld()->GetTimerManager().ClearTimer(TimerHandle_UpdateFades);
+	}
+}
+
+void UCSStuckArrowSubsystem::FreeSlot(FCSStuckArrowBatch& Batch, int32 Slot)
+{
+	FCSStuckArrowSlot& ArrowSlot = Batch.Slots[Slot];
+	ArrowSlot.Used = false;
+
+	//Hidden with a zero scale and kept so the other instance indices don't change
+	FTransform HiddenTransform(ArrowSlot.Transform.GetRotation(), ArrowSlot.Transform.GetLocation(), FVector::ZeroVector);
+	Batch.InstancedMesh->UpdateInstanceTransform(Slot, HiddenTransform, true, true, true);
+
+	Batch.UsedSlots.Remove(Slot);
+	Batch.FreeSlots.Add(Slot);
+}
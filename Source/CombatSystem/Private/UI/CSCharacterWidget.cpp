@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "UI/CSCharacterWidget.h"
+
+#include "CSCharacter.h"
+
+void UCSCharacterWidget::NativeTick(const FGeometry& MyGeometry, float InDeltaTime)
+{
+	Super::NativeTick(MyGeometry, InDeltaTime);
+
+	//Characters destroyed while bound, such as enemies that are not pooled, are dropped
+	if (!IsValid(Character))
+	{
+		Character = nullptr;
+		return;
+	}
+
+	const FCSCharacterUIModel& Model = Character->GetUIModel();
+	CSUIModelField Changes = SendWholeModel ? (CSUIModelField)((1 << FCSCharacterUIModel::NumFields) - 1) : Model.GetChangesSince(LastModelSerial);
+	if (Changes == CSUIModelField::NONE) { return; }
+
+	SendWholeModel = false;
+	LastModelSerial = Model.Serial;
+	OnUIModelChanged(Model, (int32)Changes);
+}
+
+void UCSCharacterWidget::BindCharacter(ACSCharacter* NewCharacter)
+{
+	Character = NewCharacter;
+	SendWholeModel = true;
+}
+
+bool UCSCharacterWidget::HasFieldChanged(int32 ChangedFields, CSUIModelField Field)
+{
+	return EnumHasAnyFlags((CSUIModelField)ChangedFields, Field);
+}
@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "UI/CSHUD.h"
+
+#include "CSCharacter.h"
+#include "Actions/CSCharacterState.h"
+#include "Subsystems/CSCharacterRegistry.h"
+#include "Engine/Canvas.h"
+#include "CanvasItem.h"
+#include "SceneView.h"
+#include "RenderUtils.h"
+#include "../../CombatSystem.h"
+
+static int32 NativeCombatOverlay = 0;
+FAutoConsoleVariableRef CVARNativeCombatOverlay(
+	TEXT("CS.NativeCombatOverlay"),
+	NativeCombatOverlay,
+	TEXT("Draw the enemy health bars and markers from the HUD in a single batch, off by default as the blueprint widgets already draw them"),
+	ECVF_Cheat);
+
+DECLARE_CYCLE_STAT(TEXT("Combat Overlay"), STAT_CSCombatOverlay, STATGROUP_CombatSystem);
+
+ACSHUD::ACSHUD()
+{
+	MaxDrawDistance = 3000.0f;
+	BarHeightOffset = 120.0f;
+	BarSize = FVector2D(80.0f, 6.0f);
+	ShowFullHealthBars = false;
+	MarkerSize = 8.0f;
+
+	BarBackgroundColor = FLinearColor(0.0f, 0.0f, 0.0f, 0.6f);
+	BarHealthColor = FLinearColor(0.7f, 0.05f, 0.05f, 1.0f);
+	TargetMarkerColor = FLinearColor(1.0f, 1.0f, 1.0f, 0.9f);
+	WarningMarkerColor = FLinearColor(1.0f, 0.5f, 0.0f, 1.0f);
+}
+
+void ACSHUD::DrawHUD()
+{
+	Super::DrawHUD();
+
+	if (NativeCombatOverlay > 0)
+	{
+		DrawEnemyOverlay();
+	}
+}
+
+void ACSHUD::DrawEnemyOverlay()
+{
+	SCOPE_CYCLE_COUNTER(STAT_CSCombatOverlay);
+
+	UCSCharacterRegistry* CharacterRegistry = GetWorld()->GetSubsystem<UCSCharacterRegistry>();
+	if (CharacterRegistry == nullptr || Canvas == nullptr || Canvas->SceneView == nullptr) { return; }
+
+	APawn* PlayerPawn = GetOwningPawn();
+	FVector ViewLocation = Canvas->SceneView->ViewMatrices.GetViewOrigin();
+	FMatrix ViewProjection = Canvas->SceneView->ViewMatrices.GetViewProjectionMatrix();
+	FVector2D ViewSize(Canvas->ClipX, Canvas->ClipY);
+	float MaxDistanceSquared = MaxDrawDistance * MaxDrawDistance;
+
+	OverlayTriangles.Reset();
+
+	//Project and build every element in the same loop, only reading what the character already keeps
+	for (ACSCharacter* Enemy : CharacterRegistry->GetCharacters())
+	{
+		if (Enemy == nullptr || Enemy == PlayerPawn) { continue; }
+
+		const FCSCharacterUIModel& Model = Enemy->GetUIModel();
+		if (Model.HealthPercentage <= 0.0f) { continue; }
+
+		bool IsWarning = Enemy->GetCurrentState() == CharacterStateType::ATTACK;
+		if (!ShowFullHealthBars && !Model.IsTarget && !IsWarning && Model.HealthPercentage >= 1.0f) { continue; }
+
+		FVector BarLocation = Enemy->GetActorLocation() + FVector(0.0f, 0.0f, BarHeightOffset);
+		if (FVector::DistSquared(BarLocation, ViewLocation) > MaxDistanceSquared) { continue; }
+
+		FPlane ClipPosition = ViewProjection.TransformFVector4(FVector4(BarLocation, 1.0f));
+		if (ClipPosition.W <= 0.0f) { continue; }
+
+		float InverseW = 1.0f / ClipPosition.W;
+		FVector2D ScreenPosition((ClipPosition.X * InverseW * 0.5f + 0.5f) * ViewSize.X, (0.5f - ClipPosition.Y * InverseW * 0.5f) * ViewSize.Y);
+		if (ScreenPosition.X < -BarSize.X || ScreenPosition.X > ViewSize.X + BarSize.X || ScreenPosition.Y < -BarSize.Y || ScreenPosition.Y > ViewSize.Y + BarSize.Y) { continue; }
+
+		FVector2D BarMin = ScreenPosition - BarSize * 0.5f;
+		FVector2D BarMax = ScreenPosition + BarSize * 0.5f;
+		AddRectangle(BarMin, BarMax, BarBackgroundColor);
+		AddRectangle(BarMin, FVector2D(BarMin.X + BarSize.X * FMath::Clamp(Model.HealthPercentage, 0.0f, 1.0f), BarMax.Y), BarHealthColor);
+
+		if (Model.IsTarget)
+		{
+			AddDiamond(FVector2D(ScreenPosition.X, BarMin.Y - MarkerSize * 1.5f), MarkerSize, TargetMarkerColor);
+		}
+
+		if (IsWarning)
+		{
+			AddDiamond(FVector2D(BarMax.X + MarkerSize * 1.5f, ScreenPosition.Y), MarkerSize, WarningMarkerColor);
+		}
+	}
+
+	if (OverlayTriangles.Num() == 0) { return; }
+
+	FCanvasTriangleItem OverlayItem(OverlayTriangles, GWhiteTexture);
+	OverlayItem.BlendMode = SE_BLEND_Translucent;
+	Canvas->DrawItem(OverlayItem);
+}
+
+void ACSHUD::AddRectangle(const FVector2D& Min, const FVector2D& Max, const FLinearColor& Color)
+{
+	FCanvasUVTri& First = OverlayTriangles.AddDefaulted_GetRef();
+	First.V0_Pos = Min;
+	First.V1_Pos = FVector2D(Max.X, Min.Y);
+	First.V2_Pos = Max;
+	First.V0_Color = First.V1_Color = First.V2_Color = Color;
+
+	FCanvasUVTri& Second = OverlayTriangles.AddDefaulted_GetRef();
+	Second.V0_Pos = Min;
+	Second.V1_Pos = Max;
+	Second.V2_Pos = FVector2D(Min.X, Max.Y);
+	Second.V0_Color = Second.V1_Color = Second.V2_Color = Color;
+}
+
+void ACSHUD::AddDiamond(const FVector2D& Center, float Size, const FLinearColor& Color)
+{
+	FVector2D Top = Center - FVector2D(0.0f, Size);
+	FVector2D Bottom = Center + FVector2D(0.0f, Size);
+	FVector2D Left = Center - FVector2D(Size, 0.0f);
+	FVector2D Right = Center + FVector2D(Size, 0.0f);
+
+	FCanvasUVTri& First = OverlayTriangles.AddDefaulted_GetRef();
+	First.V0_Pos = Top;
+	First.V1_Pos = Right;
+	First.V2_Pos = Bottom;
+	First.V0_Color = First.V1_Color = First.V2_Color = Color;
+
+	FCanvasUVTri& Second = OverlayTriangles.AddDefaulted_GetRef();
+	Second.V0_Pos = Top;
+	Second.V1_Pos = Bottom;
+	Second.V2_Pos = Left;
+	Second.V0_Color = Second.V1_Color = Second.V2_Color = Color;
+}
@@ -8,6 +8,7 @@
 
 class UAnimMontage;
 class UForceFeedbackEffect;
+struct FCSDamageEvent;
 
 UCLASS()
 class COMBATSYSTEM_API UCSCharacterState_Block : public UCSCharacterState
@@ -43,7 +44,7 @@ public:
 	void UpdateState(float DeltaTime) override;
 	void ExitState() override;
 
-	void OnImpact(float& Damage, const UDamageType* DamageType, AController* InstigatedBy, AActor* DamageCauser);
+	void OnImpact(float& Damage, const FCSDamageEvent& DamageEvent);
 
 	UPROPERTY(EditDefaultsOnly, Category = "Block")
 		FRotator BlockAnimationCorrection;
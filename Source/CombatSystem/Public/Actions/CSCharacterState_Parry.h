@@ -47,4 +47,6 @@ public:
 	void ExitState() override;
 
 	void OnAnimationNotify(FString AnimationNotifyName) override;
+
+	void OnParrySucceeded(ACSCharacter* ParriedCharacter);
 };
@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "CSMontageTimingTable.generated.h"
+
+class UAnimMontage;
+class USkeletalMesh;
+
+//Montage time at which an anim notify is fired
+USTRUCT()
+struct FCSMontageNotifyTiming
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, Category = "Montage Timings")
+	FName NotifyName;
+
+	UPROPERTY(VisibleAnywhere, Category = "Montage Timings")
+	float Time = 0.0f;
+};
+
+//Component space transforms of a socket sampled at a fixed rate along the montage
+USTRUCT()
+struct FCSMontageSocketTrack
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, Category = "Montage Timings")
+	FName SocketName;
+
+	UPROPERTY()
+	TArray<FTransform> Samples;
+};
+
+USTRUCT()
+struct FCSMontageTiming
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, Category = "Montage Timings")
+	float Length = 0.0f;
+
+	UPROPERTY(VisibleAnywhere, Category = "Montage Timings")
+	float SampleRate = 0.0f;
+
+	//Sorted by time
+	UPROPERTY(VisibleAnywhere, Category = "Montage Timings")
+	TArray<FCSMontageNotifyTiming> Notifies;
+
+	UPROPERTY(VisibleAnywhere, Category = "Montage Timings")
+	TArray<FCSMontageSocketTrack> SocketTracks;
+
+	/*Interpolates the component space transform of the socket at the given montage time*/
+	bool SampleSocket(FName SocketName, float Time, FTransform& OutTransform) const;
+};
+
+/**
+ * Notify timings and socket trajectories of the combat montages, extracted offline so the dedicated server
+ * can drive combat timing without ticking animation.
+ * Rebuilt from the editor or with the CSBuildMontageTimings commandlet.
+ */
+UCLASS(BlueprintType)
+class COMBATSYSTEM_API UCSMontageTimingTable : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UCSMontageTimingTable();
+
+	const FCSMontageTiming* FindTiming(const UAnimMontage* Montage) const;
+
+#if WITH_EDITOR
+	UFUNCTION(CallInEditor, Category = "Montage Timings")
+	void RebuildTimings();
+#endif
+
+protected:
+	/*Mesh whose sockets are sampled, it must use the skeleton of the montages*/
+	UPROPERTY(EditAnywhere, Category = "Montage Timings")
+	USkeletalMesh* SkeletalMesh;
+
+	UPROPERTY(EditAnywhere, Category = "Montage Timings")
+	TArray<UAnimMontage*> Montages;
+
+	/*Sockets used by combat queries, such as the weapon socket for blade sweeps or the foot socket for kicks*/
+	UPROPERTY(EditAnywhere, Category = "Montage Timings")
+	TArray<FName> SampledSockets;
+
+	UPROPERTY(EditAnywhere, Category = "Montage Timings")
+	float SampleRate;
+
+	UPROPERTY(VisibleAnywhere, Category = "Montage Timings")
+	TMap<UAnimMontage*, FCSMontageTiming> Timings;
+
+#if WITH_EDITOR
+	bool BuildTiming(UAnimMontage* Montage, FCSMontageTiming& OutTiming) const;
+
+	bool GetSocketTransformAtTime(UAnimMontage* Montage, FName SocketName, float Time, FTransform& OutTransform) const;
+#endif
+};
@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CSCharacter.h"
+#include "CSAICharacter.generated.h"
+
+/**
+ * Combat character driven by AI. It is never viewed through, so the spring arm, camera and camera manager of the
+ * player are not created at all.
+ */
+UCLASS()
+class COMBATSYSTEM_API ACSAICharacter : public ACSCharacter
+{
+	GENERATED_BODY()
+
+protected:
+	ACSAICharacter(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+};
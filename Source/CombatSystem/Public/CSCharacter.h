@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "UI/CSCharacterUIModel.h"
 #include "CSCharacter.generated.h"
 
 class ACharacter;
@@ -12,16 +13,25 @@ class UCameraComponent;
 class USpringArmComponent;
 class ACSWeapon;
 class ACSShield;
+class UMeshComponent;
 class ACSRangedWeapon;
 
 class UCSHealthComponent;
 class UCSStaminaComponent;
 class UCSCameraManagerComponent;
+class UCSHitboxComponent;
+class UCSMontageTimelineComponent;
+class UCSProjectileNetComponent;
+class UCSMeleeWeaponComponent;
 
 class UCSCharacterState;
+class UCSCharacterState_Hit;
+class UCSCharacterState_Block;
 enum class CharacterStateType : uint8;
+struct FCSDamageEvent;
 
 class UNiagaraSystem;
+class UCameraShakeBase;
 
 DECLARE_DELEGATE_OneParam(CSStateDelegate, CharacterStateType);
 DECLARE_DELEGATE_ThreeParams(CSStateKeyDelegate, CharacterStateType, FString, EInputEvent);
@@ -32,6 +42,14 @@ enum class CSCombatType : uint8
 	RANGED
 };
 
+//How much cosmetic feedback is worth playing for an exchange, gameplay is resolved the same way for all of them
+enum class CSCosmeticDetail : uint8
+{
+	NONE,
+	REDUCED,
+	FULL
+};
+
 UCLASS()
 class COMBATSYSTEM_API ACSCharacter : public ACharacter
 {
@@ -40,11 +58,13 @@ class COMBATSYSTEM_API ACSCharacter : public ACharacter
 
 protected:
 	// Sets default values for this character's properties
-	ACSCharacter();
+	ACSCharacter(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	UPROPERTY(EditDefaultsOnly, BlueprintReadonly, Category = "CSCharacter")
 		UNiagaraSystem* DestroyNiagaraSystem;
 
@@ -87,8 +107,27 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadonly, Category = "Components")
 		UCSStaminaComponent* StaminaComp;
 
-	UFUNCTION()
-		void OnHealthChanged(UCSHealthComponent* HealthComponent, float CurrentHealth, float HealthDelta, const class UDamageType* DamageType, class AController* InstigatedBy, AActor* DamageCauser);
+	UPROPERTY(EditDefaultsOnly, BlueprintReadonly, Category = "Components")
+		UCSHitboxComponent* HitboxComp;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadonly, Category = "Components")
+		UCSMontageTimelineComponent* MontageTimelineComp;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadonly, Category = "Components")
+		UCSProjectileNetComponent* ProjectileNetComp;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadonly, Category = "Components")
+		UCSMeleeWeaponComponent* MeleeWeaponComp;
+
+	//UI Model ===========================================================================================
+	FCSCharacterUIModel UIModel;
+
+	//Changes not sent to the legacy blueprint events yet, sent once on the next frame
+	CSUIModelField PendingLegacyUIChanges;
+	FTimerHandle TimerHandle_LegacyUIEvents;
+
+	void MarkUIModelChanged(CSUIModelField Field);
+	void SendLegacyUIEvents();
 
 	//Target Locking =======================================================================================
 	UPROPERTY(VisibleAnywhere, BlueprintReadonly)
@@ -116,6 +155,13 @@ protected:
 
 	void OnDetectNearbyEnemies();
 
+	//Targeting and enemy detection look along the camera, or the control rotation without one
+	FVector GetViewForwardVector() const;
+	FVector GetViewRightVector() const;
+
+	//Estimated memory of the camera components of this character with their allocations, reported in STAT_CSCameraComponentsMemory
+	int64 CameraComponentsMemory;
+
 	TArray<ACharacter*> NearbyEnemies;
 
 	//States ==============================================================================================
@@ -131,6 +177,10 @@ protected:
 	UPROPERTY(BlueprintReadonly)
 		CharacterStateType CurrentState;
 
+	//Typed shortcuts to the states used when resolving damage
+	UCSCharacterState_Hit* HitState;
+	UCSCharacterState_Block* BlockState;
+
 	void AddState(TSubclassOf<UCSCharacterState> ActionClass);
 
 	UFUNCTION(BlueprintCallable)
@@ -141,11 +191,17 @@ protected:
 
 	void NotifyActionToState(CharacterStateType StateType, FString ActionName, EInputEvent KeyEvent);
 
-	bool Parriable;
+	//Animation notifies closing a state, as routed by the animation blueprint
+	static const TMap<FName, CharacterStateType>& GetStateEndNotifies();
+
+	/*Parry windows opened through SetParriable close after this time even if the montage never closes them*/
+	UPROPERTY(EditDefaultsOnly, Category = "CSCharacter")
+		float MaxParryWindowDuration;
 
 	void SpawnEquipment();
 
 	// Weapon ==============================================================================================
+	//Never ticks, its blade is swept by the melee weapon component
 	ACSWeapon* CurrentWeapon;
 
 	UPROPERTY(EditDefaultsOnly, Category = "Player")
@@ -155,7 +211,9 @@ protected:
 		FName WeaponAttachSocketName;
 
 	//Shield ===============================================================================================
-	ACSShield* CurrentShield;
+	//The shield never acts on its own, it is only a mesh built from the defaults of the shield class
+	UPROPERTY()
+	UMeshComponent* ShieldMeshComp;
 
 	UPROPERTY(EditDefaultsOnly, Category = "Player")
 		TSubclassOf<ACSShield> StarterShieldClass;
@@ -164,6 +222,7 @@ protected:
 		FName ShieldAttachSocketName;
 
 	//Ranged Weapon ========================================================================================
+	//Only spawned once it is needed, enemies that never aim don't keep a bow around
 	ACSRangedWeapon* CurrentRangedWeapon;
 
 	UPROPERTY(EditDefaultsOnly, Category = "Player")
@@ -180,6 +239,8 @@ public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
+	virtual void PossessedBy(AController* NewController) override;
+
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
@@ -193,11 +254,32 @@ public:
 	UFUNCTION(BlueprintCallable)
 		UCSStaminaComponent* GetStaminaComponent() const;
 
+	UCSHitboxComponent* GetHitboxComponent() const;
+
+	UCSProjectileNetComponent* GetProjectileNetComponent() const;
+
+	virtual float PlayAnimMontage(UAnimMontage* AnimMontage, float InPlayRate = 1.0f, FName StartSectionName = NAME_None) override;
+	virtual void StopAnimMontage(UAnimMontage* AnimMontage = nullptr) override;
+
+	/*Handles a notify of the montage timing table the same way the animation blueprint handles the anim notify*/
+	void OnMontageTimelineNotify(FName NotifyName);
+
+	bool IsUsingMontageTimings() const;
+
+	/*Socket transform used by combat queries, sampled from the montage timing table when animation is not ticked*/
+	FTransform GetCombatSocketTransform(FName SocketName) const;
+
 	UFUNCTION(BlueprintCallable)
 		ACSWeapon* GetCurrentWeapon();
 
+	UFUNCTION(BlueprintCallable)
+		UCSMeleeWeaponComponent* GetMeleeWeaponComponent() const;
+
 	ACSRangedWeapon* GetCurrentRangedWeapon() const;
 
+	/*Returns the ranged weapon, spawning it hidden the first time it is needed*/
+	ACSRangedWeapon* SpawnRangedWeapon();
+
 	bool IsTargetLocked() const;
 
 	UFUNCTION(BlueprintCallable)
@@ -206,9 +288,15 @@ public:
 	UFUNCTION(BlueprintCallable)
 		UCSCharacterState* GetCharacterState(CharacterStateType StateType);
 
+	UCSCharacterState_Hit* GetHitState() const;
+	UCSCharacterState_Block* GetBlockState() const;
+
+	void OnHealthChanged(const FCSDamageEvent& DamageEvent, float CurrentHealth);
+
 	UFUNCTION(BlueprintCallable)
 		ACSCharacter* GetLockedTarget() const;
 
+	//Legacy UI events, only sent from the UI model while CS.LegacyUIEvents is on
 	UFUNCTION(BlueprintImplementableEvent)
 		void OnSetAsTarget(bool IsTarget);
 
@@ -246,11 +334,21 @@ public:
 
 	void ChangeCombatType(CSCombatType NewCombatType);
 
+	//Null on characters that never have a camera, like ACSAICharacter
 	UCSCameraManagerComponent* GetCameraManager() const;
 
+	void PlayCameraShake(TSubclassOf<UCameraShakeBase> CameraShake, float Scale);
+	void StopCameraShake(TSubclassOf<UCameraShakeBase> CameraShake);
+
 	void PlayForceFeedback(UForceFeedbackEffect* ForceFeedback, FForceFeedbackParameters ForceFeedbackParameters = FForceFeedbackParameters());
 	void StopForceFeedback(UForceFeedbackEffect* ForceFeedback);
 
+	/*From 0 to 1, how noticeable feedback between this character and Other is: 1 when a local player takes part,
+	 *falling off with the distance to the closest local view and 0 when neither of them was recently rendered*/
+	float GetCosmeticSignificance(const AActor* Other = nullptr) const;
+
+	CSCosmeticDetail GetCosmeticDetail(const AActor* Other = nullptr) const;
+
 	float GetMovementSpeed() const;
 	void SetMaxWalkSpeed(float NewMaxWalkSpeed);
 	void ResetMaxWalkSpeed();
@@ -261,6 +359,16 @@ public:
 	UFUNCTION(BlueprintImplementableEvent)
 		void UpdateStamina(float UpdatedStamina);
 
+	//UI Model ===========================================================================================
+	UFUNCTION(BlueprintPure)
+		const FCSCharacterUIModel& GetUIModel() const;
+
+	void SetUIHealth(float HealthPercentage);
+	void SetUIStamina(float StaminaPercentage);
+	void SetUITarget(bool IsTarget);
+	void SetUICrosshairActive(bool Active);
+	void NotifyUIHit();
+
 	UFUNCTION(BlueprintCallable)
 		FRotator GetAimRotation();
 
@@ -281,4 +389,12 @@ public:
 	float MaxDistanceToEnemies;
 
 	void StartDestroy();
+
+	void PlayDestroyEffect();
+
+	/*Takes the character out of play without destroying it, the equipment stays attached but hidden*/
+	void DeactivateCharacter();
+
+	/*Puts the character back in play at the transform as if it had just spawned, even from a ragdoll*/
+	void ResetCharacter(const FTransform& NewTransform);
 };
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Chaos/ChaosEngineInterface.h"
+#include "Templates/SubclassOf.h"
+
+class ACSCharacter;
+class UDamageType;
+
+/**
+ * Everything needed to resolve a single hit, passed straight to the victim instead of going through ApplyDamage.
+ */
+struct FCSDamageEvent
+{
+	TWeakObjectPtr<ACSCharacter> Attacker;
+
+	//Weapon or projectile that dealt the damage
+	TWeakObjectPtr<AActor> DamageCauser;
+
+	//Where the causer was when the hit was queued, since hits are resolved later in the frame and pooled arrows may be reused by then
+	FVector DamageCauserLocation = FVector::ZeroVector;
+
+	uint8 AttackSubstate = 0u;
+
+	float BaseDamage = 0.0f;
+	float DamageMultiplier = 1.0f;
+
+	EPhysicalSurface SurfaceType = SurfaceType_Default;
+
+	//Damage applied through the engine has no impact point
+	bool bHasImpactPoint = false;
+	FVector ImpactPoint = FVector::ZeroVector;
+	FVector ImpactNormal = FVector::ZeroVector;
+
+	TSubclassOf<UDamageType> DamageType;
+
+	float GetDamage() const { return BaseDamage * DamageMultiplier; }
+};
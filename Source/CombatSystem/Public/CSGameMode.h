@@ -11,6 +11,7 @@
  */
 
 class ACSCharacter;
+struct FStreamableHandle;
 
 UENUM(BlueprintType)
 enum class EWaveState : uint8
@@ -22,6 +23,27 @@ enum class EWaveState : uint8
 	GameOver
 };
 
+//Enemy class joining the waves in a range, preloaded with what it references and spawned into its pool before those waves
+USTRUCT(BlueprintType)
+struct FCSWaveEnemyArchetype
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditDefaultsOnly, Category = "Wave")
+	TSoftClassPtr<ACSCharacter> EnemyClass;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Wave")
+	int32 FirstWave = 1;
+
+	/*0 keeps the archetype in every wave after the first one*/
+	UPROPERTY(EditDefaultsOnly, Category = "Wave")
+	int32 LastWave = 0;
+
+	/*Enemies of the archetype spawned into the pool during the break before its waves*/
+	UPROPERTY(EditDefaultsOnly, Category = "Wave")
+	int32 PrewarmCount = 1;
+};
+
 
 UCLASS()
 class COMBATSYSTEM_API ACSGameMode : public AGameModeBase
@@ -46,6 +68,42 @@ protected:
 	UFUNCTION(BlueprintImplementableEvent, Category = "GameMode")
 		void SpawnNewEnemy();
 
+	/*Enemy of every wave, streamed in with the wave assets, then the enemies of the coming wave are spawned into its pool a few per frame*/
+	UPROPERTY(EditDefaultsOnly, Category = "GameMode")
+		TSoftClassPtr<ACSCharacter> EnemyClass;
+
+	/*Other enemies joining some of the waves, spawned from blueprint with SpawnPooledEnemy*/
+	UPROPERTY(EditDefaultsOnly, Category = "GameMode")
+		TArray<FCSWaveEnemyArchetype> EnemyArchetypes;
+
+	/*Assets of the waves the enemies don't reference, such as effects and sounds used from blueprints*/
+	UPROPERTY(EditDefaultsOnly, Category = "GameMode")
+		TArray<TSoftObjectPtr<UObject>> WavePreloadAssets;
+
+	int32 GetEnemiesToSpawn(int32 Wave) const;
+
+	/*EnemyClass with the whole wave as prewarm count, then the archetypes whose range holds the wave*/
+	void GetWaveEnemyArchetypes(int32 Wave, TArray<FCSWaveEnemyArchetype>& OutArchetypes) const;
+
+	//Wave Preload =========================================================================================
+	//Kept until the next preload so the assets of the current wave stay resident
+	TSharedPtr<FStreamableHandle> WavePreloadHandle;
+
+	double WavePreloadStartTime;
+
+	//The break between waves ended while the assets were still loading
+	bool StartWaveWhenLoaded;
+
+	//Assets softly referenced by each enemy class, the asset registry is only walked once per class
+	mutable TMap<FSoftObjectPath, TArray<FSoftObjectPath>> EnemySoftReferences;
+
+	const TArray<FSoftObjectPath>& GetEnemySoftReferences(const FSoftObjectPath& EnemyClassPath) const;
+
+	virtual void BuildWavePreloadManifest(int32 Wave, TArray<FSoftObjectPath>& OutManifest) const;
+	void PreloadWaveAssets(int32 Wave);
+	void OnWaveAssetsLoaded();
+	void OnTimeBetweenWavesElapsed();
+
 	void SpawnEnemyTimerElapsed();
 
 	void StartWave();
@@ -62,9 +120,15 @@ protected:
 	void ResetGame();
 	void GameOver();
 
+	/*Puts the arena back to its first wave without reloading the level, CS.SoftReset 0 reopens the level instead*/
+	void SoftResetGame();
+
 	UFUNCTION(BlueprintImplementableEvent, Category = "GameMode")
 		void OnGameOver();
 
+	UFUNCTION(BlueprintImplementableEvent, Category = "GameMode")
+		void OnGameReset();
+
 	UPROPERTY(BlueprintReadOnly, Category = "GameMode")
 		EWaveState WaveState;
 
@@ -88,6 +152,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "GameMode")
 		void AddEnemy(ACSCharacter* Enemy);
 
+	/*Reuses a pooled enemy of the class, or EnemyClass when none is given, and adds it to the wave*/
+	UFUNCTION(BlueprintCallable, Category = "GameMode")
+		ACSCharacter* SpawnPooledEnemy(TSubclassOf<ACSCharacter> SpawnClass, const FTransform& SpawnTransform);
+
 	UFUNCTION(BlueprintCallable, Category = "GameMode")
 		int32 GetAliveEnemies();
 
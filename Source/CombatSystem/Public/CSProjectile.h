@@ -4,12 +4,14 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Subsystems/CSImpactEffectSubsystem.h"
 #include "CSProjectile.generated.h"
 
 class UStaticMeshComponent;
 class UBoxComponent;
 class UNiagaraSystem;
 class UNiagaraComponent;
+class USoundBase;
 
 UCLASS()
 class COMBATSYSTEM_API ACSProjectile : public AActor
@@ -44,7 +46,9 @@ protected:
 
 	UNiagaraComponent* TrailComponent;
 
-	void PlayImpactEffects(EPhysicalSurface SurfaceType, FVector ImpactPoint);
+	/*Effects by surface, surfaces missing from the table use the effects below*/
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectile")
+	FCSImpactEffectTable ImpactEffectTable;
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectile")
 	UNiagaraSystem* DefaultImpactEffect;
@@ -60,11 +64,39 @@ protected:
 
 	float DamageMultiplier;
 
+	/*Distance the arrow sinks into the surface it hits*/
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectile")
+	float PenetrationDepth;
+
 	bool CanBeDestroyed;
 
+	FTimerHandle TimerHandle_CanBeDestroyed;
+
 	void SetCanBeDestroyed();
 
-	EPhysicalSurface DetectCollidedPhysicalSurface();
+	//Pooling ==============================================================================================
+	//False while the projectile waits in its pool
+	bool InUse;
+
+	//Physics simulation set up in the blueprint, restored when the projectile is reused
+	bool SimulatesPhysicsByDefault;
+
+	//True once the projectile stopped and stays where it hit, such as an arrow stuck in a movable object
+	bool Settled;
+
+	//Simulation ===========================================================================================
+	//True while the projectile is flown by the projectile simulation instead of physics
+	bool SimulatedFlight;
+
+	//Networking ===========================================================================================
+	//Id of the networked shot this arrow belongs to, 0 when it is not networked
+	uint16 NetId;
+
+	//Only shows the arrow, of a shot resolved by the server or of a benchmark, it never deals damage
+	bool Cosmetic;
+
+	/*Stops the projectile where it hit, stuck in the world or back in its pool*/
+	void Settle(bool Stick, UPrimitiveComponent* OtherComp);
 
 public:	
 	// Called every frame
@@ -74,5 +106,37 @@ public:
 
 	void SetDamageMultiplier(float NewDamageMultiplier);
 
+	float GetDamageMultiplier() const;
+
 	UBoxComponent* GetCollisionComponent() const;
+
+	/*Resets a pooled projectile and places it at the spawn transform*/
+	void ActivateProjectile(const FTransform& SpawnTransform, AActor* NewOwner);
+
+	/*Hides the projectile and turns off its collision, physics, trail and timers until it is reused*/
+	void DeactivateProjectile();
+
+	void ReturnToPool();
+
+	bool IsInUse() const;
+
+	bool IsSettled() const;
+
+	/*Sends the projectile flying, through the projectile simulation when allowed or as a physics body otherwise*/
+	void Launch(const FVector& Impulse, bool UseSimulation);
+
+	void BeginSimulatedFlight();
+	void EndSimulatedFlight(const FVector& Location, const FVector& Velocity);
+
+	/*Damage and impact effects against the actor the projectile collided with*/
+	void OnImpact(const FHitResult& Hit);
+
+	void GetImpactEffects(EPhysicalSurface SurfaceType, UNiagaraSystem*& OutImpactEffect, USoundBase*& OutImpactSound) const;
+
+	void SetNetId(uint16 NewNetId, bool IsCosmetic);
+	void SetCosmetic(bool IsCosmetic);
+	uint16 GetNetId() const;
+
+	/*Ends a cosmetic arrow where the server arrow of its shot ended*/
+	void ApplyAuthoritativeImpact(const FVector& ImpactPoint, const FVector& ImpactNormal, bool Stuck);
 };
@@ -7,8 +7,14 @@
 #include "CSShield.generated.h"
 
 class USkeletalMeshComponent;
-class UBoxComponent;
-
+class UMeshComponent;
+class UStaticMesh;
+class ACSCharacter;
+
+/**
+ * Shield setup of a character. It is not spawned, characters build a mesh component from the defaults of the class
+ * with CreateMeshComponent so the shield costs neither an actor nor a tick.
+ */
 UCLASS()
 class COMBATSYSTEM_API ACSShield : public AActor
 {
@@ -25,8 +31,11 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	USkeletalMeshComponent* MeshComp;
 
-public:
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	/*Used instead of the skeletal mesh when set, shields have no bones to animate*/
+	UPROPERTY(EditDefaultsOnly, Category = "Shield")
+	UStaticMesh* StaticMesh;
 
+public:
+	/*Creates the shield mesh on the character, attached to the given socket*/
+	UMeshComponent* CreateMeshComponent(ACSCharacter* Character, FName SocketName) const;
 };
@@ -11,6 +11,7 @@ class UBoxComponent;
 class UDamageType;
 class UParticleSystem;
 class UNiagaraSystem;
+class USoundBase;
 class ACSCharacter;
 
 UCLASS()
@@ -29,8 +30,6 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	USkeletalMeshComponent* MeshComp;
 
-	virtual void PlayImpactEffects(EPhysicalSurface SurfaceType, FVector ImpactPoint);
-
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
 	float DamageAmount;
 
@@ -39,9 +38,17 @@ protected:
 
 	ACSCharacter* Character;
 
+	/*Keeps the skeletal mesh ticking for weapons with their own animations, rigid weapons only follow their socket*/
+	UPROPERTY(EditDefaultsOnly, Category = "Weapon")
+	bool AnimatedMesh;
+
 public:	
 	void SetCharacter(ACSCharacter* NewCharacter);
 
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	//Cosmetics are spawned by the hit resolution stage, weapons only pick them
+	virtual void GetImpactEffects(EPhysicalSurface SurfaceType, uint8 AttackSubstate, UNiagaraSystem*& OutImpactEffect, USoundBase*& OutImpactSound) const;
+
+	float GetDamageAmount() const;
+
+	TSubclassOf<UDamageType> GetDamageType() const;
 };
@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CSBuildMontageTimingsCommandlet.generated.h"
+
+/**
+ * Rebuilds and saves every montage timing table of the project.
+ * Run it before cooking the server: UnrealEditor-Cmd CombatSystem.uproject -run=CSBuildMontageTimings
+ */
+UCLASS()
+class COMBATSYSTEM_API UCSBuildMontageTimingsCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UCSBuildMontageTimingsCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
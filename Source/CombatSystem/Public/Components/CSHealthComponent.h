@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "CSDamageEvent.h"
+#include "Components/CSRegeneratingValue.h"
 #include "CSHealthComponent.generated.h"
 
 class ACSCharacter;
@@ -27,30 +29,51 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadonly, Category = "HealthComponent")
 	float MaxHealth;
 	
-	float CurrentHealth;
+	FCSRegeneratingValue Health;
 
+	//Only players regenerate health, and never once dead
 	UPROPERTY(EditAnywhere, Category = "HealthComponent")
 	float HealthRecuperationPerSecond;
 
+	/*Fraction of the max health regenerated between two updates of the bar, 0 only updates it when full*/
+	UPROPERTY(EditAnywhere, Category = "HealthComponent")
+	float RegenNotificationStep;
+
+	FTimerHandle TimerHandle_RegenNotification;
+
+	void ScheduleRegenNotification();
+	void SendRegenNotification();
+
 	UFUNCTION()
 	void HandleTakeAnyDamage(AActor* DamagedActor, float Damage, const class UDamageType* DamageType, class AController* InstigatedBy, AActor* DamageCauser);
 
 	bool Invulnerable;
 
-public:	
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	//Blueprint notifications are sent once per frame no matter how many hits were received
+	FTimerHandle TimerHandle_HealthChangedNotification;
+	float PendingHealthDelta;
+	FCSDamageEvent LastDamageEvent;
 
+	void QueueHealthChangedNotification(const FCSDamageEvent& DamageEvent, float HealthDelta);
+	void SendHealthChangedNotification();
+
+public:	
 	UPROPERTY(BlueprintAssignable, Category = "Events")
 	FOnHealthChangedSignature OnHealthChanged;	
 
 	ACSCharacter* Character;
 
+	void ApplyCombatDamage(const FCSDamageEvent& DamageEvent);
+
+	/*Back to full health with no pending notifications, for characters reused instead of spawned*/
+	void ResetHealth();
+
 	bool IsInvulnerable() const;
 	
 	UFUNCTION(BlueprintCallable)
 	void SetInvulnerable(bool NewInvulnerable);
 
-	float GetHealthPercentage();
+	float GetHealthPercentage() const;
 
 	float GetCurrentHealth() const;
 };
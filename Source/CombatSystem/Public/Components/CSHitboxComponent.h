@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Chaos/ChaosEngineInterface.h"
+#include "CSHitboxComponent.generated.h"
+
+class USkeletalMeshComponent;
+
+//Capsule following a bone, defined by a segment in bone space
+USTRUCT(BlueprintType)
+struct FCSHitbox
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditDefaultsOnly, Category = "Hitbox")
+	FName BoneName;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Hitbox")
+	FVector StartOffset = FVector::ZeroVector;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Hitbox")
+	FVector EndOffset = FVector::ZeroVector;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Hitbox")
+	float Radius = 10.0f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Hitbox")
+	TEnumAsByte<EPhysicalSurface> SurfaceType = EPhysicalSurface::SurfaceType1;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Hitbox")
+	float DamageMultiplier = 1.0f;
+};
+
+struct FCSHitboxHit
+{
+	EPhysicalSurface SurfaceType;
+	float DamageMultiplier;
+	FVector ImpactPoint;
+};
+
+/**
+ * Lightweight capsules on the character bones used to find the hit zone of weapons and projectiles analytically.
+ * Bone transforms are only read when an attack is tested against the character, at most once per frame.
+ */
+UCLASS(ClassGroup=(CombatSystem), meta=(BlueprintSpawnableComponent))
+class COMBATSYSTEM_API UCSHitboxComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:	
+	UCSHitboxComponent();
+
+protected:
+	virtual void BeginPlay() override;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Hitboxes")
+	TArray<FCSHitbox> Hitboxes;
+
+	USkeletalMeshComponent* MeshComp;
+
+	TArray<int32> BoneIndices;
+	TArray<FVector> WorldStarts;
+	TArray<FVector> WorldEnds;
+
+	uint64 LastUpdateFrame;
+
+	void UpdateHitboxes();
+
+public:	
+	/*Finds the first hitbox touched by a segment of the given radius, going from SegmentStart to SegmentEnd*/
+	bool IntersectSegment(const FVector& SegmentStart, const FVector& SegmentEnd, float SegmentRadius, FCSHitboxHit& OutHit);
+
+	/*Finds the hitbox whose surface is the closest to the given point*/
+	bool FindClosestHitbox(const FVector& Point, FCSHitboxHit& OutHit);
+};
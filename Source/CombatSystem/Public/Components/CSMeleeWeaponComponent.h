@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "CSMeleeWeaponComponent.generated.h"
+
+class ACSCharacter;
+class ACSMeleeWeapon;
+
+/**
+ * Sweeps the blade of the melee weapon of a character during the damage windows, so the weapon actor itself never ticks.
+ * Only ticks between the EnableDamage and DisableDamage notifies.
+ */
+UCLASS(ClassGroup=(CombatSystem))
+class COMBATSYSTEM_API UCSMeleeWeaponComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UCSMeleeWeaponComponent();
+
+protected:
+	virtual void BeginPlay() override;
+
+	ACSCharacter* Character;
+
+	UPROPERTY()
+	ACSMeleeWeapon* Weapon;
+
+	bool DamageEnabled;
+
+	FTransform LastBladeTransform;
+
+	FTransform GetBladeTransform() const;
+
+	//Actors already hit during the current damage window
+	TSet<AActor*> SwingHitActors;
+
+	void SweepBlade();
+
+	void OnBladeHit(const FHitResult& Hit, const FTransform& BladeTransform);
+
+public:
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	void SetWeapon(ACSMeleeWeapon* NewWeapon);
+
+	ACSMeleeWeapon* GetWeapon() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Weapon")
+	void SetDamageEnabled(bool Enabled);
+};
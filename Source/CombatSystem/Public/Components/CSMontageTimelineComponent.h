@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "CSMontageTimelineComponent.generated.h"
+
+class ACSCharacter;
+class UAnimMontage;
+class UCSMontageTimingTable;
+struct FCSMontageTiming;
+
+/**
+ * Plays back the precomputed timings of the combat montages on the dedicated server, where the pose is only
+ * ticked when rendered and anim notifies are never fired.
+ * Only ticks while a montage with timings is playing.
+ */
+UCLASS(ClassGroup=(CombatSystem), meta=(BlueprintSpawnableComponent))
+class COMBATSYSTEM_API UCSMontageTimelineComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:	
+	UCSMontageTimelineComponent();
+
+protected:
+	virtual void BeginPlay() override;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Montage Timings")
+	UCSMontageTimingTable* TimingTable;
+
+	ACSCharacter* Character;
+
+	bool UseTimings;
+
+	UAnimMontage* CurrentMontage;
+	const FCSMontageTiming* CurrentTiming;
+
+	float CurrentPosition;
+	float CurrentPlayRate;
+	int32 NextNotifyIndex;
+
+	//Changes whenever a montage starts or stops so notifies can tell their timeline was replaced
+	uint32 TimelineSerial;
+
+	void StopTimeline();
+
+public:	
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	bool IsUsingTimings() const;
+
+	void OnMontagePlayed(UAnimMontage* Montage, float PlayRate, FName StartSectionName);
+	void OnMontageStopped(UAnimMontage* Montage);
+
+	/*World transform of a socket sampled from the playing montage, false if it has no track for it*/
+	bool GetSocketTransform(FName SocketName, FTransform& OutTransform) const;
+};
@@ -0,0 +1,138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Engine/NetSerialization.h"
+#include "CSProjectileNetComponent.generated.h"
+
+class ACSCharacter;
+class ACSProjectile;
+
+//Everything needed to fly the same arrow on every machine
+USTRUCT()
+struct FCSProjectileSpawnParams
+{
+	GENERATED_BODY()
+
+	//Matches the arrows of a shot across machines, unique per shooter
+	uint16 ProjectileId = 0;
+
+	FVector_NetQuantize10 Origin;
+	FVector_NetQuantizeNormal Direction;
+
+	//Charge ratio of the bow, quantized to a byte over [0, MaxCharge]
+	uint8 QuantizedCharge = 0;
+
+	//Seeds the spread of the weapon so every machine picks the same direction
+	uint16 Seed = 0;
+
+	static constexpr float MaxCharge = 1.5f;
+
+	void SetCharge(float Charge);
+	float GetCharge() const;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FCSProjectileSpawnParams> : public TStructOpsTypeTraitsBase2<FCSProjectileSpawnParams>
+{
+	enum { WithNetSerializer = true };
+};
+
+//Where the authoritative arrow of a shot ended, only used for cosmetics on clients
+USTRUCT()
+struct FCSProjectileHitParams
+{
+	GENERATED_BODY()
+
+	uint16 ProjectileId = 0;
+
+	FVector_NetQuantize10 ImpactPoint;
+	FVector_NetQuantizeNormal ImpactNormal;
+
+	uint8 SurfaceType = 0;
+
+	//The arrow stays in the world instead of disappearing
+	bool Stuck = false;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FCSProjectileHitParams> : public TStructOpsTypeTraitsBase2<FCSProjectileHitParams>
+{
+	enum { WithNetSerializer = true };
+};
+
+/**
+ * Networks the arrows of a character without replicating projectile actors. The shooting client flies a cosmetic arrow
+ * right away while the server flies the authoritative one, only the spawn parameters of the shot and the final hit are sent.
+ * Every machine spawns its arrows from its own pool and matches them by id.
+ */
+UCLASS(ClassGroup=(CombatSystem), meta=(BlueprintSpawnableComponent))
+class COMBATSYSTEM_API UCSProjectileNetComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UCSProjectileNetComponent();
+
+protected:
+	virtual void BeginPlay() override;
+
+	ACSCharacter* Character;
+
+	uint16 LastProjectileId;
+
+	/*Furthest the origin sent by a client can be from the bow on the server before the server origin is used instead*/
+	UPROPERTY(EditDefaultsOnly, Category = "Projectiles")
+	float MaxOriginError;
+
+	/*Half angle in degrees of the cone around the view of the client its arrows are kept in by the server*/
+	UPROPERTY(EditDefaultsOnly, Category = "Projectiles")
+	float MaxAimError;
+
+	/*Seconds of charge a client can have on top of what the server measured, for the jitter of its connection*/
+	UPROPERTY(EditDefaultsOnly, Category = "Projectiles")
+	float MaxChargeTimeError;
+
+	//Server time the bow of the client started to be drawn, negative while it isn't
+	float ServerChargeStartTime;
+
+	float LastServerShotTime;
+
+	//Cosmetic arrows still waiting for the result of the server
+	TMap<uint16, TWeakObjectPtr<ACSProjectile>> CosmeticProjectiles;
+
+	ACSProjectile* FindCosmeticProjectile(uint16 ProjectileId) const;
+	void RemoveFinishedCosmeticProjectiles();
+
+	void SpawnProjectile(const FCSProjectileSpawnParams& Params, bool Cosmetic);
+
+	UFUNCTION(Server, Reliable)
+	void ServerStartCharge();
+
+	UFUNCTION(Server, Reliable)
+	void ServerFireProjectile(const FCSProjectileSpawnParams& Params);
+
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastProjectileFired(const FCSProjectileSpawnParams& Params);
+
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastProjectileHit(const FCSProjectileHitParams& Params);
+
+public:
+	bool IsNetworked() const;
+
+	/*Lets the server measure the charge of the next shot itself*/
+	void StartCharge();
+
+	/*Fires the shot through the network, predicted when called on the owning client*/
+	void FireProjectile(FCSProjectileSpawnParams Params);
+
+	/*Sends the hit of an authoritative arrow to the clients*/
+	void OnAuthoritativeImpact(const FCSProjectileHitParams& Params);
+};
@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Value that regenerates linearly up to a cap, evaluated from the last time it was set instead of integrated every frame.
+ */
+struct FCSRegeneratingValue
+{
+	float Value = 0.0f;
+	float Timestamp = 0.0f;
+	float Rate = 0.0f;
+	float Max = 0.0f;
+
+	float Get(float Time) const
+	{
+		return FMath::Min(Max, Value + Rate * FMath::Max(Time - Timestamp, 0.0f));
+	}
+
+	void Set(float NewValue, float NewRate, float Time)
+	{
+		Value = FMath::Clamp(NewValue, 0.0f, Max);
+		Rate = NewRate;
+		Timestamp = Time;
+	}
+
+	bool IsRegenerating(float Time) const
+	{
+		return Rate > 0.0f && Get(Time) < Max;
+	}
+
+	/*Seconds from Time until the value reaches Target, 0 if it already did or never will*/
+	float GetTimeUntil(float Target, float Time) const
+	{
+		float CurrentValue = Get(Time);
+		if (Rate <= 0.0f || CurrentValue >= Target) { return 0.0f; }
+
+		return (FMath::Min(Target, Max) - CurrentValue) / Rate;
+	}
+
+	//Shortest delay between two steps, so float rounding can't land just under a step and schedule it again right away
+	static constexpr float MinStepDelay = 0.05f;
+
+	/*Seconds from Time until the value reaches its next multiple of Step (a ratio of Max) or Max, 0 if it isn't regenerating*/
+	float GetTimeUntilNextStep(float Time, float Step) const
+	{
+		if (!IsRegenerating(Time) || Max <= 0.0f) { return 0.0f; }
+
+		//The step is picked from a bit ahead so a value sitting right under a step moves on to the next one
+		float Percentage = Get(Time + MinStepDelay) / Max;
+		float NextPercentage = Step > 0.0f ? FMath::Min((FMath::FloorToFloat(Percentage / Step) + 1.0f) * Step, 1.0f) : 1.0f;
+		return FMath::Max(GetTimeUntil(NextPercentage * Max, Time), MinStepDelay);
+	}
+};
@@ -2,6 +2,7 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "Components/CSRegeneratingValue.h"
 #include "CSStaminaComponent.generated.h"
 
 class ACSCharacter;
@@ -20,17 +21,28 @@ protected:
 	UPROPERTY(EditAnywhere, Category = "Stamina")
 	float MaxStamina;
 
-	float CurrentStamina;
+	FCSRegeneratingValue Stamina;
 
 	UPROPERTY(EditAnywhere, Category = "Stamina")
 	float StaminaRecuperationPerSecond;
 
+	/*Fraction of the max stamina regenerated between two updates of the bar, 0 only updates it when full*/
+	UPROPERTY(EditAnywhere, Category = "Stamina")
+	float RegenNotificationStep;
+
+	FTimerHandle TimerHandle_RegenNotification;
+
+	void ScheduleRegenNotification();
+	void SendRegenNotification();
+
 	ACSCharacter* Character;
 
 public:	
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
-
 	bool HasEnoughStamina(float DesiredStaminaConsumption);
 	void ConsumeStamina(float StaminaToConsume);
+
+	/*Back to full stamina, for characters reused instead of spawned*/
+	void ResetStamina();
+	float GetCurrentStamina() const;
 	float GetStaminaPercentage() const;
 };
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "CSWeapon.h"
 #include "Actions/CSCharacterState_Attack.h"
+#include "Subsystems/CSImpactEffectSubsystem.h"
 
 #include "CSMeleeWeapon.generated.h"
 
@@ -15,6 +16,10 @@ class UNiagaraComponent;
 class ACSCharacter;
 
 
+/**
+ * Melee weapon of a character, with the components and graph of its blueprint such as the sword trail.
+ * It never ticks, the blade is swept by the UCSMeleeWeaponComponent of the character during the damage windows.
+ */
 UCLASS()
 class COMBATSYSTEM_API ACSMeleeWeapon : public ACSWeapon
 {
@@ -23,19 +28,30 @@ class COMBATSYSTEM_API ACSMeleeWeapon : public ACSWeapon
 public:
 	ACSMeleeWeapon();
 
-	UFUNCTION(BlueprintCallable)
-		void SetDamageEnabled(bool Enabled);
+	UBoxComponent* GetBladeComponent() const;
 
-	void OnAttackBegin(CharacterSubstateType_Attack AttackSubstate);
+	float GetMaxSweepSubstepAngle() const;
 
-protected:
-	virtual void BeginPlay() override;
+	int32 GetMaxSweepSubsteps() const;
+
+	void GetImpactEffects(EPhysicalSurface SurfaceType, uint8 AttackSubstate, UNiagaraSystem*& OutImpactEffect, USoundBase*& OutImpactSound) const override;
 
+protected:
+	/*Only used as the shape and collision responses of the blade sweeps, its own collision is always disabled*/
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 		UBoxComponent* CollisionComp;
 
-	UFUNCTION()
-		void OnBeginOverlap(class UPrimitiveComponent* OverlappedComponent, class AActor* OtherActor, class UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+	//Blade Sweeps =========================================================================================
+	/*Maximum blade rotation in degrees covered by a single sweep, faster swings are split into more substeps*/
+	UPROPERTY(EditDefaultsOnly, Category = "Weapon|Sweep")
+		float MaxSweepSubstepAngle;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Weapon|Sweep")
+		int32 MaxSweepSubsteps;
+
+	/*Effects by surface and attack substate, surfaces missing from the table use the effects below*/
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+		FCSImpactEffectTable ImpactEffectTable;
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
 		UNiagaraSystem* DefaultImpactEffect;
@@ -54,8 +70,4 @@ protected:
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon|Sounds")
 		USoundBase* SecondarySlashSound;
-
-	void PlayImpactEffects(EPhysicalSurface SurfaceType, FVector ImpactPoint) override;
-
-	bool DamageEnabled;
 };
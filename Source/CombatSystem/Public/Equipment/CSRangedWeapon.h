@@ -9,6 +9,7 @@
 
 class ACSProjectile;
 class ACSCharacter;
+struct FCSProjectileSpawnParams;
 
 UCLASS()
 class COMBATSYSTEM_API ACSRangedWeapon : public ACSWeapon
@@ -34,15 +35,42 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "Ranged Weapon")
 	float MaxChargeTime;
 
+	/*Shortest time between two shots, the server rejects the shots of a client sent faster than this*/
+	UPROPERTY(EditDefaultsOnly, Category = "Ranged Weapon")
+	float MinTimeBetweenShots;
+
 	void OnMaxChargeTimeReached();
 
-	float CalculateDamageMultiplier();
+	float CalculateDamageMultiplier(float Charge) const;
 
 	UPROPERTY(EditDefaultsOnly, Category = "Projectiles")
 	TSubclassOf<ACSProjectile> DefaultProjectileClass;
+
+	/*Projectiles spawned in the pool when the weapon begins play*/
+	UPROPERTY(EditDefaultsOnly, Category = "Projectiles")
+	int32 PrewarmedProjectiles;
+
+	/*Maximum projectiles of the class alive at once, the oldest one is reused past it. 0 means no cap*/
+	UPROPERTY(EditDefaultsOnly, Category = "Projectiles")
+	int32 MaxProjectiles;
 	
+	/*Half angle in degrees of the random spread of the arrows, seeded by the shot so every machine flies the same arrow*/
+	UPROPERTY(EditDefaultsOnly, Category = "Projectiles")
+	float SpreadAngle;
+
 	FVector CalculateProjectileDestination();
 
+	//Aim Assist ===========================================================================================
+	/*Half angle in degrees of the cone around the crosshair in which characters are considered as targets*/
+	UPROPERTY(EditDefaultsOnly, Category = "Ranged Weapon|Aim Assist")
+	float AimAssistConeAngle;
+
+	/*Values between 0.0 and 1.0, 0.0 keeps the crosshair direction and 1.0 sends the arrow right to the target*/
+	UPROPERTY(EditDefaultsOnly, Category = "Ranged Weapon|Aim Assist")
+	float AimAssistStrength;
+
+	ACSCharacter* FindAimAssistTarget(const FVector& ViewLocation, const FVector& ViewDirection) const;
+
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Ranged Weapon|Sounds")
 	USoundBase* RecoilSound;
 
@@ -51,6 +79,20 @@ protected:
 
 public:	
 	void StartRecoiling();
+
+	TSubclassOf<ACSProjectile> GetProjectileClass() const;
+
+	FVector GetProjectileSpawnLocation() const;
 	
 	void Shoot();
+
+	/*Plays the sound of a shot, also used for the shots of other machines*/
+	void PlayShootSound();
+
+	float GetMaxChargeTime() const;
+
+	float GetMinTimeBetweenShots() const;
+
+	/*Spawns and launches the arrow of a shot, cosmetic arrows only show a shot resolved by the server*/
+	ACSProjectile* SpawnProjectile(const FCSProjectileSpawnParams& Params, bool Cosmetic);
 };
@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CSCharacterRegistry.generated.h"
+
+class ACSCharacter;
+
+/**
+ * Flat list of the combat characters alive in the world, so systems that need to look at every
+ * combatant can iterate it instead of running overlap queries.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCSCharacterRegistry : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	UPROPERTY()
+	TArray<ACSCharacter*> Characters;
+
+public:
+	void RegisterCharacter(ACSCharacter* Character);
+	void UnregisterCharacter(ACSCharacter* Character);
+
+	const TArray<ACSCharacter*>& GetCharacters() const;
+};
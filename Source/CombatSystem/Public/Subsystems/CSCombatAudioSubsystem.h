@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CSCombatAudioSubsystem.generated.h"
+
+class USoundBase;
+
+UENUM(BlueprintType)
+enum class CSCombatSoundCategory : uint8
+{
+	IMPACT,
+	SWING,
+	HIT_REACTION,
+	WEAPON,
+
+	MAX UMETA(Hidden)
+};
+
+//A combat sound that is still playing, tracked from its duration instead of its active sound
+struct FCSCombatVoice
+{
+	const USoundBase* Sound = nullptr;
+	FVector Location = FVector::ZeroVector;
+	float StartTime = 0.0f;
+	float EndTime = 0.0f;
+};
+
+/**
+ * Single place where combat sounds are played. Sounds are culled by distance to the listeners, merged with the same sound
+ * started nearby an instant before and limited per category before an active sound is ever created.
+ * Sounds involving a local player can use a few voices over the category limit so they are the last ones dropped.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCSCombatAudioSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	TArray<FCSCombatVoice> Voices[(uint8)CSCombatSoundCategory::MAX];
+
+	bool IsPlayerInvolved(const AActor* Actor) const;
+	bool IsAudibleByAnyListener(const USoundBase* Sound, const FVector& Location) const;
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/*Returns false when the sound was culled, merged or over the limit of its category*/
+	bool PlayCombatSound(USoundBase* Sound, const FVector& Location, CSCombatSoundCategory Category, const AActor* Instigator = nullptr, const AActor* Other = nullptr);
+};
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CSEnemyPoolSubsystem.generated.h"
+
+class ACSCharacter;
+class AController;
+
+//A deactivated enemy and the controller that possesses it again when it is reused
+USTRUCT()
+struct FCSPooledEnemy
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	ACSCharacter* Enemy = nullptr;
+
+	UPROPERTY()
+	AController* Controller = nullptr;
+};
+
+USTRUCT()
+struct FCSEnemyPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FCSPooledEnemy> FreeEnemies;
+
+	UPROPERTY()
+	TArray<ACSCharacter*> ActiveEnemies;
+
+	//Enemies PrewarmPool still has to spawn over the next frames
+	int32 PendingPrewarm = 0;
+
+	int32 HighWaterMark = 0;
+};
+
+/**
+ * Keeps a pool of enemies per class so waves don't spawn and destroy characters, enemies are deactivated instead of
+ * destroyed, with their equipment and controller, and reset when reused.
+ * Prewarming spawns the missing enemies a few per frame, within CS.EnemySpawnBudgetMs.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCSEnemyPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	UPROPERTY()
+	TMap<TSubclassOf<ACSCharacter>, FCSEnemyPool> Pools;
+
+	FTimerHandle TimerHandle_Prewarm;
+
+	void PrewarmNextEnemies();
+
+	/*Spawns an enemy out of play and without a controller*/
+	ACSCharacter* SpawnPooledEnemy(TSubclassOf<ACSCharacter> EnemyClass);
+	FCSPooledEnemy DeactivateEnemy(ACSCharacter* Enemy);
+
+	void RemoveInvalidEnemies(FCSEnemyPool& Pool);
+
+public:
+	virtual void Deinitialize() override;
+
+	/*Spawns enemies over the next frames until the pool has Count of them*/
+	void PrewarmPool(TSubclassOf<ACSCharacter> EnemyClass, int32 Count);
+
+	bool IsPrewarming() const;
+
+	/*Puts a free enemy back in play at the transform, an enemy is only spawned when the pool is empty*/
+	ACSCharacter* AcquireEnemy(TSubclassOf<ACSCharacter> EnemyClass, const FTransform& SpawnTransform);
+
+	/*Takes the enemy out of play, enemies that don't come from the pool are destroyed*/
+	void ReleaseEnemy(ACSCharacter* Enemy);
+
+	int32 GetHighWaterMark(TSubclassOf<ACSCharacter> EnemyClass) const;
+};
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineBaseTypes.h"
+#include "CSDamageEvent.h"
+#include "CSHitResolutionSubsystem.generated.h"
+
+class UCSHitResolutionSubsystem;
+class UNiagaraSystem;
+class USoundBase;
+
+//A hit detected by a weapon or projectile, waiting to be resolved at the end of the frame
+struct FCSHitRecord
+{
+	FCSDamageEvent DamageEvent;
+
+	TWeakObjectPtr<AActor> Victim;
+
+	//Hits on world geometry only play cosmetics
+	bool bDealsDamage = false;
+
+	//Lets the attacker play its strike feedback, once per frame
+	bool bNotifyAttacker = false;
+
+	TWeakObjectPtr<UNiagaraSystem> ImpactEffect;
+	TWeakObjectPtr<USoundBase> ImpactSound;
+
+	//Projectiles can be destroyed before the hit is resolved so duplicates are matched by id
+	uint32 DamageCauserID = 0u;
+
+	uint32 Sequence = 0u;
+};
+
+USTRUCT()
+struct FCSHitResolutionTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	UCSHitResolutionSubsystem* Subsystem = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FCSHitResolutionTickFunction> : public TStructOpsTypeTraitsBase2<FCSHitResolutionTickFunction>
+{
+	enum { WithCopy = false };
+};
+
+/**
+ * Collects the hits detected during the frame and resolves them all together after physics:
+ * damage and state changes first, then attacker feedback, then a pass of impact cosmetics, budgeted by the effect and audio subsystems.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCSHitResolutionSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	FCSHitResolutionTickFunction ResolutionTickFunction;
+
+	TArray<FCSHitRecord> PendingHits;
+	TArray<FCSHitRecord> ResolvingHits;
+
+	uint32 NextSequence;
+
+	void ResolveDamage();
+	void NotifyAttackers();
+	void PlayImpactCosmetics();
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	void AddHit(FCSHitRecord&& HitRecord);
+
+	void ResolveHits();
+};
@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Chaos/ChaosEngineInterface.h"
+#include "CSImpactEffectSubsystem.generated.h"
+
+class UNiagaraSystem;
+class UNiagaraComponent;
+class USoundBase;
+
+USTRUCT(BlueprintType)
+struct FCSImpactEffectEntry
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Impact")
+	TEnumAsByte<EPhysicalSurface> SurfaceType = SurfaceType_Default;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Impact")
+	bool AnySubstate = true;
+
+	/*Attack substate of the hit, entries with a substate win over the ones matching any substate*/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Impact", meta = (EditCondition = "!AnySubstate"))
+	uint8 AttackSubstate = 0u;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Impact")
+	UNiagaraSystem* Effect = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Impact")
+	USoundBase* Sound = nullptr;
+};
+
+/**
+ * Impact effects of a weapon or projectile by surface type and attack substate, scanned in a single pass.
+ */
+USTRUCT(BlueprintType)
+struct FCSImpactEffectTable
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Impact")
+	TArray<FCSImpactEffectEntry> Entries;
+
+	/*Returns false when no entry matches the surface so the caller can use its defaults*/
+	bool Find(EPhysicalSurface SurfaceType, uint8 AttackSubstate, UNiagaraSystem*& OutEffect, USoundBase*& OutSound) const;
+};
+
+//Effect that didn't fit in the budget of its frame and waits for the next ones
+USTRUCT()
+struct FCSQueuedImpactEffect
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	UNiagaraSystem* Effect = nullptr;
+
+	FVector Location = FVector::ZeroVector;
+	FRotator Rotation = FRotator::ZeroRotator;
+};
+
+/**
+ * Single place where combat effects are spawned. Effects come from the Niagara component pool, are limited per frame
+ * and per system, and are skipped when they are too far from every local view or behind it.
+ * Essential effects, such as the destroy effect of a character, are not limited per system and wait for the next frames
+ * instead of being dropped when the frame budget is spent.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCSImpactEffectSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	//Frame the budget counters belong to
+	uint64 BudgetFrame;
+
+	int32 FrameSpawns;
+
+	TMap<const UNiagaraSystem*, int32> FrameSystemSpawns;
+
+	UPROPERTY()
+	TArray<FCSQueuedImpactEffect> QueuedEffects;
+
+	FTimerHandle TimerHandle_QueuedEffects;
+
+	void UpdateBudgetFrame();
+
+	bool IsVisibleFromAnyView(const FVector& Location) const;
+
+	UNiagaraComponent* SpawnPooledEffect(UNiagaraSystem* Effect, const FVector& Location, const FRotator& Rotation);
+
+	void SpawnQueuedEffects();
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/*Spawns a pooled effect, returns null when it was culled or the budget of the frame is spent*/
+	UNiagaraComponent* SpawnImpactEffect(UNiagaraSystem* Effect, const FVector& Location, const FRotator& Rotation = FRotator::ZeroRotator);
+
+	/*Spawns an effect that must not be dropped by the budget, it is delayed to the next frames when the frame budget is spent*/
+	void SpawnEssentialEffect(UNiagaraSystem* Effect, const FVector& Location, const FRotator& Rotation = FRotator::ZeroRotator);
+};
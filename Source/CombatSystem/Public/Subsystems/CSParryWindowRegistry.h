@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CSParryWindowRegistry.generated.h"
+
+class ACSCharacter;
+class UCSCharacterState_Parry;
+
+//Time span in which an attacker can be parried, opened by its attack montage
+USTRUCT()
+struct FCSParryWindow
+{
+	GENERATED_BODY()
+
+	TWeakObjectPtr<ACSCharacter> Attacker;
+
+	float StartTime = 0.0f;
+	float EndTime = 0.0f;
+};
+
+//Defender whose parry animation is currently able to catch an attack
+USTRUCT()
+struct FCSActiveParry
+{
+	GENERATED_BODY()
+
+	TWeakObjectPtr<ACSCharacter> Defender;
+	TWeakObjectPtr<UCSCharacterState_Parry> ParryState;
+
+	float Range = 0.0f;
+};
+
+/**
+ * Keeps the parry windows of the arena so parries are resolved once, when either side opens its window,
+ * instead of defenders scanning nearby enemies every frame.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCSParryWindowRegistry : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	TArray<FCSParryWindow> ParryWindows;
+	TArray<FCSActiveParry> ActiveParries;
+
+	void RemoveExpiredWindows(float CurrentTime);
+
+	bool CanParry(ACSCharacter* Defender, float Range, const FCSParryWindow& Window, float Time) const;
+
+public:
+	//Attackers ===========================================================================================
+	void OpenParryWindow(ACSCharacter* Attacker, float MaxDuration);
+	void CloseParryWindow(ACSCharacter* Attacker);
+
+	bool HasActiveParryWindow(const ACSCharacter* Attacker) const;
+
+	//Defenders ===========================================================================================
+	void BeginParry(ACSCharacter* Defender, UCSCharacterState_Parry* ParryState, float Range);
+	void EndParry(ACSCharacter* Defender);
+};
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CSProjectilePoolSubsystem.generated.h"
+
+class ACSProjectile;
+
+USTRUCT()
+struct FCSProjectilePool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<ACSProjectile*> FreeProjectiles;
+
+	//Oldest first, the settled ones are reclaimed when the pool reaches its cap
+	UPROPERTY()
+	TArray<ACSProjectile*> ActiveProjectiles;
+
+	//Past it settled projectiles are reused, the pool only grows when every projectile is still flying
+	int32 MaxProjectiles = 0;
+
+	int32 HighWaterMark = 0;
+};
+
+/**
+ * Keeps a pool of projectiles per class so shooting doesn't spawn actors, projectiles are deactivated
+ * instead of destroyed and reset when reused.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCSProjectilePoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	UPROPERTY()
+	TMap<TSubclassOf<ACSProjectile>, FCSProjectilePool> Pools;
+
+	ACSProjectile* SpawnPooledProjectile(TSubclassOf<ACSProjectile> ProjectileClass);
+
+public:
+	virtual void Deinitialize() override;
+
+	/*Spawns projectiles until the pool has Count of them, MaxProjectiles caps the projectiles alive at the same time*/
+	void PrewarmPool(TSubclassOf<ACSProjectile> ProjectileClass, int32 Count, int32 MaxProjectiles);
+
+	/*Activates a free projectile, the oldest settled one is reclaimed when the pool is at its cap*/
+	ACSProjectile* AcquireProjectile(TSubclassOf<ACSProjectile> ProjectileClass, const FTransform& SpawnTransform, AActor* NewOwner);
+
+	void ReleaseProjectile(ACSProjectile* Projectile);
+
+	/*Deactivates every projectile in flight or waiting for the net, for resetting the arena*/
+	void ReleaseAllProjectiles();
+
+	int32 GetHighWaterMark(TSubclassOf<ACSProjectile> ProjectileClass) const;
+
+	int32 GetMaxProjectiles(TSubclassOf<ACSProjectile> ProjectileClass) const;
+
+	/*Changes the cap of the pool, free projectiles past the new cap are destroyed*/
+	void SetMaxProjectiles(TSubclassOf<ACSProjectile> ProjectileClass, int32 MaxProjectiles);
+};
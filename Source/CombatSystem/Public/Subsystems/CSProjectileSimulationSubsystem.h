@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineBaseTypes.h"
+#include "CSProjectileSimulationSubsystem.generated.h"
+
+class ACSProjectile;
+class UCSProjectileSimulationSubsystem;
+
+USTRUCT()
+struct FCSProjectileSimulationTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	UCSProjectileSimulationSubsystem* Subsystem = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FCSProjectileSimulationTickFunction> : public TStructOpsTypeTraitsBase2<FCSProjectileSimulationTickFunction>
+{
+	enum { WithCopy = false };
+};
+
+enum class CSProjectileBenchmarkPhase : uint8
+{
+	NONE,
+	PHYSICS,
+	SIMULATED
+};
+
+/**
+ * Flies every in-flight arrow analytically instead of as a physics body: the ballistic state is kept in flat arrays
+ * integrated together and each arrow traces a single ray along its step. Projectile actors are only moved for rendering,
+ * hits go through the regular projectile impact.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCSProjectileSimulationSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	FCSProjectileSimulationTickFunction SimulationTickFunction;
+
+	//Simulated projectiles, all arrays share the same index
+	UPROPERTY()
+	TArray<ACSProjectile*> Projectiles;
+
+	TArray<TWeakObjectPtr<AActor>> Owners;
+
+	TArray<FVector::FReal> PositionsX;
+	TArray<FVector::FReal> PositionsY;
+	TArray<FVector::FReal> PositionsZ;
+
+	TArray<FVector::FReal> VelocitiesX;
+	TArray<FVector::FReal> VelocitiesY;
+	TArray<FVector::FReal> VelocitiesZ;
+
+	TArray<FVector::FReal> GravityScales;
+	TArray<FVector::FReal> LinearDampings;
+	TArray<FVector::FReal> DamageMultipliers;
+	TArray<float> Ages;
+
+	//Scratch arrays reused every step
+	TArray<FVector> StepStarts;
+	TArray<int32> HitIndices;
+	TArray<FHitResult> StepHits;
+
+	void Integrate(float DeltaTime);
+	void TraceSteps();
+	void ResolveImpacts();
+	void UpdateVisuals();
+
+	void RemoveProjectileAt(int32 Index);
+
+	//Benchmark ============================================================================================
+	CSProjectileBenchmarkPhase BenchmarkPhase;
+
+	TSubclassOf<ACSProjectile> BenchmarkProjectileClass;
+	FVector BenchmarkOrigin;
+	float BenchmarkLaunchSpeed;
+	int32 BenchmarkProjectileCount;
+	float BenchmarkDuration;
+
+	//Cap of the projectile pool before the benchmark filled it, restored once it ends
+	int32 BenchmarkPreviousMaxProjectiles;
+
+	float BenchmarkPhaseEndTime;
+	int32 BenchmarkFrames;
+	double BenchmarkGameThreadMilliseconds;
+	double BenchmarkSimulationMilliseconds;
+
+	UPROPERTY()
+	TArray<ACSProjectile*> BenchmarkProjectiles;
+
+	void StartBenchmarkPhase(CSProjectileBenchmarkPhase Phase);
+	void UpdateBenchmark(double SimulationMilliseconds);
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	static bool IsSimulationEnabled();
+
+	void AddProjectile(ACSProjectile* Projectile, const FVector& Velocity);
+	void RemoveProjectile(ACSProjectile* Projectile);
+
+	void Simulate(float DeltaTime);
+
+	/*Launches Count projectiles with physics and then with the analytic simulation, logging the frame cost of each*/
+	void StartBenchmark(TSubclassOf<ACSProjectile> ProjectileClass, const FVector& Origin, float LaunchSpeed, int32 Count, float Duration);
+};
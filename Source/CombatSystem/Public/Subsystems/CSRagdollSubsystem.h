@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CSRagdollSubsystem.generated.h"
+
+class USkeletalMeshComponent;
+
+//A corpse whose bodies are still simulated
+struct FCSRagdoll
+{
+	TWeakObjectPtr<USkeletalMeshComponent> Mesh;
+
+	//Consecutive checks the ragdoll was below the settle speed
+	int32 SettledChecks = 0;
+};
+
+/**
+ * Owns the ragdolls of the dead characters. Only a few of them are simulated at the same time, the rest are frozen:
+ * a ragdoll that stops moving or is the oldest one when the cap is reached keeps its last pose and leaves the physics scene.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCSRagdollSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	//Oldest first
+	TArray<FCSRagdoll> Ragdolls;
+
+	int32 FrozenRagdolls;
+
+	FTimerHandle TimerHandle_CheckSettled;
+
+	void CheckSettled();
+
+	float GetMaxBodySpeedSquared(USkeletalMeshComponent* Mesh) const;
+
+	void FreezeRagdoll(USkeletalMeshComponent* Mesh);
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+
+	/*Starts simulating the mesh, the oldest ragdoll is frozen when the cap is reached*/
+	void AddRagdoll(USkeletalMeshComponent* Mesh);
+
+	/*Stops tracking the mesh without freezing it, for characters taken back out of the ragdoll*/
+	void RemoveRagdoll(USkeletalMeshComponent* Mesh);
+};
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CSStuckArrowSubsystem.generated.h"
+
+class UStaticMesh;
+class UStaticMeshComponent;
+class UHierarchicalInstancedStaticMeshComponent;
+
+//Instance of a stuck arrow, slots are reused in place so instance indices never move
+struct FCSStuckArrowSlot
+{
+	FTransform Transform;
+
+	float StuckTime = 0.0f;
+
+	bool Used = false;
+};
+
+//All the stuck arrows sharing a mesh
+USTRUCT()
+struct FCSStuckArrowBatch
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	UHierarchicalInstancedStaticMeshComponent* InstancedMesh = nullptr;
+
+	TArray<FCSStuckArrowSlot> Slots;
+
+	//Used slots, oldest first
+	TArray<int32> UsedSlots;
+
+	TArray<int32> FreeSlots;
+};
+
+/**
+ * Arrows stuck in the world geometry are kept as instances of one instanced mesh per arrow mesh instead of actors,
+ * capped and faded out oldest first so their cost stays bounded however many arrows are shot.
+ */
+UCLASS()
+class COMBATSYSTEM_API UCSStuckArrowSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+	UPROPERTY()
+	AActor* InstancesActor;
+
+	UPROPERTY()
+	TMap<UStaticMesh*, FCSStuckArrowBatch> Batches;
+
+	FTimerHandle TimerHandle_UpdateFades;
+
+	FCSStuckArrowBatch* FindOrCreateBatch(UStaticMeshComponent* ArrowMesh);
+
+	void UpdateFades();
+
+	void FreeSlot(FCSStuckArrowBatch& Batch, int32 Slot);
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/*Copies the arrow mesh into an instance, false if it can't be instanced and the arrow actor must be kept*/
+	bool AddStuckArrow(UStaticMeshComponent* ArrowMesh);
+
+	/*Removes every stuck arrow at once, the instances are kept for the next arrows*/
+	void ClearStuckArrows();
+};
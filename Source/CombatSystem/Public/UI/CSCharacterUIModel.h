@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CSCharacterUIModel.generated.h"
+
+UENUM(BlueprintType, meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class CSUIModelField : uint8
+{
+	NONE      = 0 UMETA(Hidden),
+	HEALTH    = 1 << 0 UMETA(DisplayName = "Health"),
+	STAMINA   = 1 << 1 UMETA(DisplayName = "Stamina"),
+	TARGET    = 1 << 2 UMETA(DisplayName = "Target"),
+	CROSSHAIR = 1 << 3 UMETA(DisplayName = "Crosshair"),
+	HIT       = 1 << 4 UMETA(DisplayName = "Hit")
+};
+ENUM_CLASS_FLAGS(CSUIModelField);
+
+/**
+ * Everything the widgets show about a character. Gameplay only writes it, widgets read it once per frame and
+ * find what changed since their last read from the serials.
+ */
+USTRUCT(BlueprintType)
+struct FCSCharacterUIModel
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "UI")
+	float HealthPercentage = 1.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "UI")
+	float StaminaPercentage = 1.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "UI")
+	bool IsTarget = false;
+
+	UPROPERTY(BlueprintReadOnly, Category = "UI")
+	bool CrosshairActive = false;
+
+	//Hits received so far, several hits in a frame still play a single hit reaction
+	UPROPERTY(BlueprintReadOnly, Category = "UI")
+	int32 HitCount = 0;
+
+	static constexpr int32 NumFields = 5;
+
+	//Increased on every change, each reader keeps the last one it saw
+	uint32 Serial = 0u;
+	uint32 FieldSerials[NumFields] = {};
+
+	void MarkChanged(CSUIModelField Field)
+	{
+		Serial++;
+		for (int32 i = 0; i < NumFields; ++i)
+		{
+			if (EnumHasAnyFlags(Field, (CSUIModelField)(1 << i))) { FieldSerials[i] = Serial; }
+		}
+	}
+
+	CSUIModelField GetChangesSince(uint32 LastSerial) const
+	{
+		CSUIModelField Changes = CSUIModelField::NONE;
+		if (LastSerial == Serial) { return Changes; }
+
+		for (int32 i = 0; i < NumFields; ++i)
+		{
+			if (FieldSerials[i] > LastSerial) { Changes |= (CSUIModelField)(1 << i); }
+		}
+
+		return Changes;
+	}
+};
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "UI/CSCharacterUIModel.h"
+#include "CSCharacterWidget.generated.h"
+
+class ACSCharacter;
+
+/**
+ * Base of the widgets showing a character, such as the HUD or the enemy health bars.
+ * Reads the UI model of the bound character once per frame and only calls into the blueprint when something changed.
+ */
+UCLASS(Abstract)
+class COMBATSYSTEM_API UCSCharacterWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+protected:
+	UPROPERTY(BlueprintReadOnly, Category = "UI")
+	ACSCharacter* Character;
+
+	uint32 LastModelSerial;
+
+	//Set when a character is bound so its whole model is shown once
+	bool SendWholeModel;
+
+	virtual void NativeTick(const FGeometry& MyGeometry, float InDeltaTime) override;
+
+	/*Called at most once per frame with every field that changed since the last call*/
+	UFUNCTION(BlueprintImplementableEvent, Category = "UI")
+	void OnUIModelChanged(const FCSCharacterUIModel& Model, UPARAM(meta = (Bitmask, BitmaskEnum = "/Script/CombatSystem.CSUIModelField")) int32 ChangedFields);
+
+public:
+	/*Shows a new character, the whole model is sent as changed on the next frame*/
+	UFUNCTION(BlueprintCallable, Category = "UI")
+	void BindCharacter(ACSCharacter* NewCharacter);
+
+	UFUNCTION(BlueprintPure, Category = "UI")
+	static bool HasFieldChanged(UPARAM(meta = (Bitmask, BitmaskEnum = "/Script/CombatSystem.CSUIModelField")) int32 ChangedFields, CSUIModelField Field);
+};
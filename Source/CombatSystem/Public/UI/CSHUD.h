@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/HUD.h"
+#include "CanvasTypes.h"
+#include "CSHUD.generated.h"
+
+class ACSCharacter;
+
+/**
+ * Draws the health bars, lock-on and warning markers of every enemy in a single pass: the registered characters are
+ * projected together with the view projection of the frame and every element is added to one triangle list,
+ * instead of a widget component per enemy.
+ */
+UCLASS()
+class COMBATSYSTEM_API ACSHUD : public AHUD
+{
+	GENERATED_BODY()
+
+public:
+	ACSHUD();
+
+	virtual void DrawHUD() override;
+
+protected:
+	/*Enemies further than this from the camera are not drawn*/
+	UPROPERTY(EditDefaultsOnly, Category = "Overlay")
+	float MaxDrawDistance;
+
+	/*Height above the character location where its bar is drawn*/
+	UPROPERTY(EditDefaultsOnly, Category = "Overlay")
+	float BarHeightOffset;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Overlay")
+	FVector2D BarSize;
+
+	/*Enemies with full health only show their bar while they are the locked target*/
+	UPROPERTY(EditDefaultsOnly, Category = "Overlay")
+	bool ShowFullHealthBars;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Overlay")
+	float MarkerSize;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Overlay")
+	FLinearColor BarBackgroundColor;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Overlay")
+	FLinearColor BarHealthColor;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Overlay")
+	FLinearColor TargetMarkerColor;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Overlay")
+	FLinearColor WarningMarkerColor;
+
+	//Reused every frame
+	TArray<FCanvasUVTri> OverlayTriangles;
+
+	void AddRectangle(const FVector2D& Min, const FVector2D& Max, const FLinearColor& Color);
+	void AddDiamond(const FVector2D& Center, float Size, const FLinearColor& Color);
+
+	void DrawEnemyOverlay();
+};